@@ -0,0 +1,166 @@
+// Voxel layout benchmark: times the chunk access patterns of the mesher and the brush
+// Built once per VOXEL_LAYOUT, see RAYM_BUILD_BENCHMARKS in CMakeLists.txt
+
+#include "chunk.h"
+#include "marching_cubes.h"
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_REPEATS 20
+#define BRUSH_RADIUS 10
+
+// Function to get a monotonic-enough time in seconds
+static double GetBenchTime(void)
+{
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Function to fill a chunk with rolling terrain and caves, so most surface bricks are dense
+static void FillBenchChunk(Chunk *chunk)
+{
+  InitializeChunk(chunk, (Vector3){0});
+  for (int x = 0; x < CHUNK_SIZE; x++)
+  {
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+      for (int z = 0; z < CHUNK_SIZE; z++)
+      {
+        float height = 28.0f + 10.0f * sinf(x * 0.11f) * cosf(z * 0.09f) + 3.0f * sinf(x * 0.37f + z * 0.23f);
+        float caves = 4.0f * sinf(x * 0.21f) * sinf(y * 0.27f) * sinf(z * 0.19f);
+        float density = Clamp((y - height) * 0.25f + (y < height ? caves * 0.2f : 0.0f), -1.0f, 1.0f);
+        SetChunkVoxel(chunk, x, y, z, DensityToVoxel(density));
+      }
+    }
+  }
+  UpdateBrickSummaries(chunk, 0, 0, 0, CHUNK_SIZE - 1, CHUNK_SIZE - 1, CHUNK_SIZE - 1);
+}
+
+// Mesher count pass over every section
+static float BenchClassify(MeshingContext *context, const Chunk *chunk)
+{
+  int triangles = 0;
+  for (int sx = 0; sx < SECTIONS_PER_AXIS; sx++)
+  {
+    for (int sy = 0; sy < SECTIONS_PER_AXIS; sy++)
+    {
+      for (int sz = 0; sz < SECTIONS_PER_AXIS; sz++)
+      {
+        triangles += ClassifySection(context, chunk, sx, sy, sz);
+      }
+    }
+  }
+  return (float)triangles;
+}
+
+// 8-corner gather of every cell, the access pattern of vertex interpolation and raycasts
+static float BenchCornerGather(const Chunk *chunk)
+{
+  float sum = 0.0f;
+  for (int x = 0; x < CHUNK_SIZE - 1; x++)
+  {
+    for (int y = 0; y < CHUNK_SIZE - 1; y++)
+    {
+      for (int z = 0; z < CHUNK_SIZE - 1; z++)
+      {
+        sum += GetChunkDensity(chunk, x, y, z) + GetChunkDensity(chunk, x + 1, y, z) +
+               GetChunkDensity(chunk, x, y + 1, z) + GetChunkDensity(chunk, x + 1, y + 1, z) +
+               GetChunkDensity(chunk, x, y, z + 1) + GetChunkDensity(chunk, x + 1, y, z + 1) +
+               GetChunkDensity(chunk, x, y + 1, z + 1) + GetChunkDensity(chunk, x + 1, y + 1, z + 1);
+      }
+    }
+  }
+  return sum;
+}
+
+// Central-difference gradients of every inner voxel, the access pattern of vertex normals
+static float BenchGradients(const Chunk *chunk)
+{
+  float sum = 0.0f;
+  for (int x = 1; x < CHUNK_SIZE - 1; x++)
+  {
+    for (int y = 1; y < CHUNK_SIZE - 1; y++)
+    {
+      for (int z = 1; z < CHUNK_SIZE - 1; z++)
+      {
+        sum += GetChunkDensity(chunk, x + 1, y, z) - GetChunkDensity(chunk, x - 1, y, z);
+        sum += GetChunkDensity(chunk, x, y + 1, z) - GetChunkDensity(chunk, x, y - 1, z);
+        sum += GetChunkDensity(chunk, x, y, z + 1) - GetChunkDensity(chunk, x, y, z - 1);
+      }
+    }
+  }
+  return sum;
+}
+
+// Sphere brush read-modify-write with the loop order of ModifyTerrain
+static float BenchBrush(Chunk *chunk, int repeat)
+{
+  int cx = 16 + (repeat * 7) % 32;
+  int cy = 28;
+  int cz = 16 + (repeat * 13) % 32;
+  float strength = (repeat & 1) ? 0.01f : -0.01f;
+
+  for (int x = cx - BRUSH_RADIUS; x <= cx + BRUSH_RADIUS; x++)
+  {
+    for (int y = cy - BRUSH_RADIUS; y <= cy + BRUSH_RADIUS; y++)
+    {
+      for (int z = cz - BRUSH_RADIUS; z <= cz + BRUSH_RADIUS; z++)
+      {
+        int dx = x - cx, dy = y - cy, dz = z - cz;
+        if (dx * dx + dy * dy + dz * dz > BRUSH_RADIUS * BRUSH_RADIUS)
+          continue;
+
+        float density = GetChunkDensity(chunk, x, y, z) + strength;
+        SetChunkVoxel(chunk, x, y, z, DensityToVoxel(density));
+      }
+    }
+  }
+  UpdateBrickSummaries(chunk, cx - BRUSH_RADIUS, cy - BRUSH_RADIUS, cz - BRUSH_RADIUS,
+                       cx + BRUSH_RADIUS, cy + BRUSH_RADIUS, cz + BRUSH_RADIUS);
+  return strength;
+}
+
+int main(void)
+{
+  static Chunk chunk;
+  FillBenchChunk(&chunk);
+  MeshingContext context = InitializeMeshingContext();
+
+  const char *layout = VOXEL_LAYOUT == VOXEL_LAYOUT_MORTON ? "morton" : "linear";
+  printf("layout %s, %d-bit densities, %d of %d bricks dense\n", layout, VOXEL_DENSITY_BITS,
+         GetChunkDenseBrickCount(&chunk), BRICKS_PER_AXIS * BRICKS_PER_AXIS * BRICKS_PER_AXIS);
+
+  const char *names[4] = {"classify sections", "corner gather", "gradients", "brush"};
+  double best[4] = {1e9, 1e9, 1e9, 1e9};
+  volatile float sink = 0.0f;
+
+  for (int repeat = 0; repeat < BENCH_REPEATS; repeat++)
+  {
+    double t0 = GetBenchTime();
+    sink += BenchClassify(&context, &chunk);
+    double t1 = GetBenchTime();
+    sink += BenchCornerGather(&chunk);
+    double t2 = GetBenchTime();
+    sink += BenchGradients(&chunk);
+    double t3 = GetBenchTime();
+    sink += BenchBrush(&chunk, repeat);
+    double t4 = GetBenchTime();
+
+    double times[4] = {t1 - t0, t2 - t1, t3 - t2, t4 - t3};
+    for (int i = 0; i < 4; i++)
+    {
+      best[i] = times[i] < best[i] ? times[i] : best[i];
+    }
+  }
+
+  for (int i = 0; i < 4; i++)
+  {
+    printf("  %-18s %8.3f ms\n", names[i], best[i] * 1e3);
+  }
+
+  CleanupMeshingContext(&context);
+  CleanupChunk(&chunk);
+  return 0;
+}
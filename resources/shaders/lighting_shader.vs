@@ -1,31 +1,48 @@
 #version 330
 
-// Input vertex attributes
-in vec3 vertexPosition;
-in vec3 vertexNormal;
-in vec2 vertexTexCoord;
+// Input vertex attributes (compact chunk vertex layout)
+in vec3 vertexPosition; // Chunk-local position in fixed-point steps
+in vec2 vertexNormal;   // Octahedral-encoded normal
+in float vertexSlot;    // Page-local id of the section, selects its chunkOffsets entry
 
 // Input uniform values
 uniform mat4 mvp;
 uniform mat4 matModel;
 uniform mat4 matNormal;
+uniform float positionScale; // World units per position step
+uniform vec4 chunkOffsets[128]; // Chunk position and vertex scale of every section in the page, WORLD_PAGE_SLOTS
 
 // Output vertex attributes (to fragment shader)
 out vec3 fragPosition;
 out vec3 fragNormal;
 out vec2 fragTexCoord;
 
+// Decode an octahedral normal, the lower hemisphere is folded over the diagonals
+vec3 DecodeOctahedralNormal(vec2 encoded)
+{
+    vec3 normal = vec3(encoded.x, 1.0 - abs(encoded.x) - abs(encoded.y), encoded.y);
+    float fold = max(-normal.y, 0.0);
+    normal.x += normal.x >= 0.0 ? -fold : fold;
+    normal.z += normal.z >= 0.0 ? -fold : fold;
+    return normalize(normal);
+}
+
 void main()
 {
+    vec4 chunkOffset = chunkOffsets[int(vertexSlot)];
+    vec3 position = vertexPosition * positionScale * chunkOffset.w;
+
+    vec3 worldPosition = position + chunkOffset.xyz;
+
     // Calculate fragment position in world space
-    fragPosition = vec3(matModel * vec4(vertexPosition, 1.0));
+    fragPosition = vec3(matModel * vec4(worldPosition, 1.0));
     
     // Calculate fragment normal in world space
-    fragNormal = normalize(vec3(matNormal * vec4(vertexNormal, 0.0)));
+    fragNormal = normalize(vec3(matNormal * vec4(DecodeOctahedralNormal(vertexNormal), 0.0)));
     
-    // Pass texture coordinates to fragment shader
-    fragTexCoord = vertexTexCoord;
+    // Texture coordinates are derived from the chunk-local position
+    fragTexCoord = position.xz * 0.1;
     
     // Calculate final vertex position
-    gl_Position = mvp * vec4(vertexPosition, 1.0);
-} 
\ No newline at end of file
+    gl_Position = mvp * vec4(worldPosition, 1.0);
+}
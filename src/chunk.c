@@ -0,0 +1,175 @@
+#include "chunk.h"
+#include <math.h>
+#include <stdlib.h>
+
+void InitializeChunk(Chunk *chunk, Vector3 position)
+{
+  chunk->position = position;
+
+  Voxel air = DensityToVoxel(1.0f);
+  for (int bx = 0; bx < BRICKS_PER_AXIS; bx++)
+  {
+    for (int by = 0; by < BRICKS_PER_AXIS; by++)
+    {
+      for (int bz = 0; bz < BRICKS_PER_AXIS; bz++)
+      {
+        Brick *brick = &chunk->bricks[bx][by][bz];
+        brick->voxels = NULL;
+        brick->uniform = air;
+        brick->minDensity = VoxelToDensity(air);
+        brick->maxDensity = VoxelToDensity(air);
+      }
+    }
+  }
+}
+
+void CleanupChunk(Chunk *chunk)
+{
+  for (int bx = 0; bx < BRICKS_PER_AXIS; bx++)
+  {
+    for (int by = 0; by < BRICKS_PER_AXIS; by++)
+    {
+      for (int bz = 0; bz < BRICKS_PER_AXIS; bz++)
+      {
+        RL_FREE(chunk->bricks[bx][by][bz].voxels);
+        chunk->bricks[bx][by][bz].voxels = NULL;
+      }
+    }
+  }
+}
+
+bool CopyChunk(Chunk *dst, const Chunk *src)
+{
+  dst->position = src->position;
+
+  for (int bx = 0; bx < BRICKS_PER_AXIS; bx++)
+  {
+    for (int by = 0; by < BRICKS_PER_AXIS; by++)
+    {
+      for (int bz = 0; bz < BRICKS_PER_AXIS; bz++)
+      {
+        dst->bricks[bx][by][bz] = src->bricks[bx][by][bz];
+        dst->bricks[bx][by][bz].voxels = NULL;
+      }
+    }
+  }
+
+  for (int bx = 0; bx < BRICKS_PER_AXIS; bx++)
+  {
+    for (int by = 0; by < BRICKS_PER_AXIS; by++)
+    {
+      for (int bz = 0; bz < BRICKS_PER_AXIS; bz++)
+      {
+        const BrickVoxels *source = src->bricks[bx][by][bz].voxels;
+        if (!source)
+          continue;
+
+        BrickVoxels *voxels = (BrickVoxels *)RL_MALLOC(sizeof(BrickVoxels));
+        if (!voxels)
+        {
+          CleanupChunk(dst);
+          return false;
+        }
+        *voxels = *source;
+        dst->bricks[bx][by][bz].voxels = voxels;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool SetChunkVoxel(Chunk *chunk, int x, int y, int z, Voxel voxel)
+{
+  Brick *brick = &chunk->bricks[x / BRICK_SIZE][y / BRICK_SIZE][z / BRICK_SIZE];
+
+  if (!brick->voxels)
+  {
+    if (voxel.density == brick->uniform.density)
+      return true;
+
+    // Copy on write: expand the uniform value into dense storage
+    brick->voxels = (BrickVoxels *)RL_MALLOC(sizeof(BrickVoxels));
+    if (!brick->voxels)
+    {
+      TraceLog(LOG_WARNING, "CHUNK: Out of memory expanding brick (%d, %d, %d), voxel write dropped",
+               x / BRICK_SIZE, y / BRICK_SIZE, z / BRICK_SIZE);
+      return false;
+    }
+
+    for (int i = 0; i < BRICK_VOXELS; i++)
+    {
+      brick->voxels->voxels[i] = brick->uniform;
+    }
+  }
+
+  brick->voxels->voxels[GetBrickVoxelIndex(x % BRICK_SIZE, y % BRICK_SIZE, z % BRICK_SIZE)] = voxel;
+  return true;
+}
+
+void SetChunkBrickUniform(Chunk *chunk, int bx, int by, int bz, Voxel voxel)
+{
+  Brick *brick = &chunk->bricks[bx][by][bz];
+  RL_FREE(brick->voxels);
+  brick->voxels = NULL;
+  brick->uniform = voxel;
+  brick->minDensity = VoxelToDensity(voxel);
+  brick->maxDensity = VoxelToDensity(voxel);
+}
+
+void UpdateBrickSummaries(Chunk *chunk, int minX, int minY, int minZ, int maxX, int maxY, int maxZ)
+{
+  for (int bx = minX / BRICK_SIZE; bx <= maxX / BRICK_SIZE; bx++)
+  {
+    for (int by = minY / BRICK_SIZE; by <= maxY / BRICK_SIZE; by++)
+    {
+      for (int bz = minZ / BRICK_SIZE; bz <= maxZ / BRICK_SIZE; bz++)
+      {
+        Brick *brick = &chunk->bricks[bx][by][bz];
+        if (!brick->voxels)
+        {
+          brick->minDensity = VoxelToDensity(brick->uniform);
+          brick->maxDensity = VoxelToDensity(brick->uniform);
+          continue;
+        }
+
+        const Voxel *voxels = brick->voxels->voxels;
+        VoxelDensity minStored = voxels[0].density;
+        VoxelDensity maxStored = voxels[0].density;
+        for (int i = 1; i < BRICK_VOXELS; i++)
+        {
+          minStored = voxels[i].density < minStored ? voxels[i].density : minStored;
+          maxStored = voxels[i].density > maxStored ? voxels[i].density : maxStored;
+        }
+
+        brick->minDensity = VoxelToDensity((Voxel){minStored});
+        brick->maxDensity = VoxelToDensity((Voxel){maxStored});
+
+        // Release the storage of bricks that became uniform
+        if (minStored == maxStored)
+        {
+          brick->uniform = voxels[0];
+          RL_FREE(brick->voxels);
+          brick->voxels = NULL;
+        }
+      }
+    }
+  }
+}
+
+int GetChunkDenseBrickCount(const Chunk *chunk)
+{
+  int count = 0;
+  for (int bx = 0; bx < BRICKS_PER_AXIS; bx++)
+  {
+    for (int by = 0; by < BRICKS_PER_AXIS; by++)
+    {
+      for (int bz = 0; bz < BRICKS_PER_AXIS; bz++)
+      {
+        if (chunk->bricks[bx][by][bz].voxels)
+          count++;
+      }
+    }
+  }
+  return count;
+}
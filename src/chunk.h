@@ -2,33 +2,174 @@
 #define CHUNK_H
 
 #include "raylib.h"
+#include <math.h>
+#include <stdint.h>
 
 #define CHUNK_SIZE 64
 #define VOXEL_SIZE 1.0f
 #define CHUNKS_X 4
 #define CHUNKS_Z 4
 
+#define BRICK_SIZE 8
+#define BRICKS_PER_AXIS (CHUNK_SIZE / BRICK_SIZE)
+
+// Chunks are meshed in sections of SECTION_SIZE^3 cells, the last section on each axis is one cell short
+#define SECTION_SIZE 16
+#define SECTIONS_PER_AXIS ((CHUNK_SIZE - 1 + SECTION_SIZE - 1) / SECTION_SIZE)
+#define SECTION_COUNT (SECTIONS_PER_AXIS * SECTIONS_PER_AXIS * SECTIONS_PER_AXIS)
+
+// Voxel spacing of coarse preview chunks, a preview fits in one section
+#define CHUNK_PREVIEW_STEP (CHUNK_SIZE / SECTION_SIZE)
+
+// Density storage, chosen at compile time: 32 = float, 16 or 8 = signed fixed point
+#ifndef VOXEL_DENSITY_BITS
+#define VOXEL_DENSITY_BITS 16
+#endif
+
+#if VOXEL_DENSITY_BITS == 8
+typedef int8_t VoxelDensity;
+#define VOXEL_DENSITY_SCALE 127.0f // Stored units per unit of density, holds [-1, 1]
+#define VOXEL_DENSITY_LIMIT 127
+#elif VOXEL_DENSITY_BITS == 16
+typedef int16_t VoxelDensity;
+#define VOXEL_DENSITY_SCALE 4096.0f // Stored units per unit of density, holds [-8, 8]
+#define VOXEL_DENSITY_LIMIT 32767
+#elif VOXEL_DENSITY_BITS == 32
+typedef float VoxelDensity;
+#define VOXEL_DENSITY_SCALE 1.0f
+#else
+#error "VOXEL_DENSITY_BITS must be 8, 16 or 32"
+#endif
+
 typedef struct
 {
-  float density;
+  VoxelDensity density; // Use VoxelToDensity/DensityToVoxel to convert
 } Voxel;
 
+// Function to get the density stored in a voxel
+static inline float VoxelToDensity(Voxel voxel)
+{
+  return (float)voxel.density * (1.0f / VOXEL_DENSITY_SCALE);
+}
+
+// Function to store a density in a voxel, fixed-point storage rounds and saturates
+static inline Voxel DensityToVoxel(float density)
+{
+#if VOXEL_DENSITY_BITS == 32
+  return (Voxel){density};
+#else
+  float scaled = roundf(density * VOXEL_DENSITY_SCALE);
+  scaled = scaled < -VOXEL_DENSITY_LIMIT ? -VOXEL_DENSITY_LIMIT : (scaled > VOXEL_DENSITY_LIMIT ? VOXEL_DENSITY_LIMIT : scaled);
+  return (Voxel){(VoxelDensity)scaled};
+#endif
+}
+
+// Voxel order inside a dense brick, chosen at compile time
+#define VOXEL_LAYOUT_LINEAR 0 // x, y, z with z fastest, lines along z are contiguous
+#define VOXEL_LAYOUT_MORTON 1 // Z-order curve, neighbors along every axis stay close
+#ifndef VOXEL_LAYOUT
+#define VOXEL_LAYOUT VOXEL_LAYOUT_LINEAR
+#endif
+
+#define BRICK_VOXELS (BRICK_SIZE * BRICK_SIZE * BRICK_SIZE)
+
+// Dense voxel storage of one brick, indexed with GetBrickVoxelIndex
+typedef struct
+{
+  Voxel voxels[BRICK_VOXELS];
+} BrickVoxels;
+
+// Function to get the storage index of a voxel inside a brick, coordinates are brick-local
+static inline int GetBrickVoxelIndex(int x, int y, int z)
+{
+#if VOXEL_LAYOUT == VOXEL_LAYOUT_MORTON
+  // Interleave the three bits of each coordinate, x highest
+  int bits0 = ((x & 1) << 2) | ((y & 1) << 1) | (z & 1);
+  int bits1 = ((x & 2) << 1) | (y & 2) | ((z & 2) >> 1);
+  int bits2 = (x & 4) | ((y & 4) >> 1) | ((z & 4) >> 2);
+  return bits0 | (bits1 << 3) | (bits2 << 6);
+#elif VOXEL_LAYOUT == VOXEL_LAYOUT_LINEAR
+  return (x * BRICK_SIZE + y) * BRICK_SIZE + z;
+#else
+#error "VOXEL_LAYOUT must be VOXEL_LAYOUT_LINEAR or VOXEL_LAYOUT_MORTON"
+#endif
+}
+
+// One BRICK_SIZE^3 block of voxels, stored densely only when its voxels differ
+typedef struct
+{
+  BrickVoxels *voxels; // NULL while every voxel equals uniform
+  Voxel uniform;       // Value of every voxel of a uniform brick
+  float minDensity;    // Density range, refreshed by UpdateBrickSummaries
+  float maxDensity;
+} Brick;
+
 typedef struct
 {
   Vector3 position;
-  Voxel voxels[CHUNK_SIZE][CHUNK_SIZE][CHUNK_SIZE];
+  Brick bricks[BRICKS_PER_AXIS][BRICKS_PER_AXIS][BRICKS_PER_AXIS];
 } Chunk;
 
+// Chunk storage management, a new chunk is uniformly air
+void InitializeChunk(Chunk *chunk, Vector3 position);
+void CleanupChunk(Chunk *chunk);
+
+// Function to copy a chunk, the copy gets its own brick storage, returns false when out of memory
+bool CopyChunk(Chunk *dst, const Chunk *src);
+
+// Function to get a voxel of a chunk
+static inline Voxel GetChunkVoxel(const Chunk *chunk, int x, int y, int z)
+{
+  const Brick *brick = &chunk->bricks[x / BRICK_SIZE][y / BRICK_SIZE][z / BRICK_SIZE];
+  if (!brick->voxels)
+    return brick->uniform;
+  return brick->voxels->voxels[GetBrickVoxelIndex(x % BRICK_SIZE, y % BRICK_SIZE, z % BRICK_SIZE)];
+}
+
+// Function to get the density of a voxel of a chunk
+static inline float GetChunkDensity(const Chunk *chunk, int x, int y, int z)
+{
+  return VoxelToDensity(GetChunkVoxel(chunk, x, y, z));
+}
+
+// Function to set a voxel of a chunk, a uniform brick gets its own storage on the first differing write
+// Returns false, leaving the voxel unchanged, when that storage cannot be allocated
+bool SetChunkVoxel(Chunk *chunk, int x, int y, int z, Voxel voxel);
+
+// Function to set every voxel of a brick at once, releasing its storage
+void SetChunkBrickUniform(Chunk *chunk, int bx, int by, int bz, Voxel voxel);
+
+// Brick summaries, must be refreshed whenever voxels in the given range change
+// Bricks whose voxels all became equal again release their storage
+void UpdateBrickSummaries(Chunk *chunk, int minX, int minY, int minZ, int maxX, int maxY, int maxZ);
+
+// Function to get the number of bricks of a chunk with dense storage
+int GetChunkDenseBrickCount(const Chunk *chunk);
+
+// Independently meshed part of a chunk
+typedef struct
+{
+  int slot;   // World mesh slot holding the geometry, 0 until a surface first crosses the section
+  bool dirty; // Voxels changed since the mesh was built
+} ChunkSection;
+
+// Generated terrain height of every column of a chunk, in world units
+typedef struct
+{
+  float heights[CHUNK_SIZE][CHUNK_SIZE]; // Indexed [vx][vz]
+  float minHeight;
+  float maxHeight;
+} ChunkHeightfield;
+
 typedef struct
 {
   Chunk chunk;
-  Mesh mesh;
-  Model model;
+  ChunkHeightfield heightfield; // Kept from generation for height queries
+  ChunkSection sections[SECTIONS_PER_AXIS][SECTIONS_PER_AXIS][SECTIONS_PER_AXIS];
+  int previewSlot; // World mesh slot of the coarse stand-in drawn until the chunk is initialized, 0 for none
   bool initialized;
   bool needsUpdate;
-  float updateTimer;
-  float minHeight;
-  float maxHeight;
+  bool remeshing; // A remesh request is in flight, see RequestChunkRemesh
 } ChunkData;
 
 #endif // CHUNK_H
\ No newline at end of file
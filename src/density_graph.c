@@ -0,0 +1,323 @@
+#include "density_graph.h"
+#include "raymath.h"
+#include <math.h>
+#include <stddef.h>
+
+// Padding of noise and distance ranges, covers float rounding in the evaluated values
+#define DENSITY_BOUND_SLACK 1e-3f
+
+DensityGraph InitializeDensityGraph(void)
+{
+  DensityGraph graph = {0};
+  return graph;
+}
+
+// Function to get the number of inputs a node type reads
+static int GetDensityNodeInputCount(DensityNodeType type)
+{
+  switch (type)
+  {
+  case DENSITY_NODE_ADD:
+  case DENSITY_NODE_SUBTRACT:
+  case DENSITY_NODE_MULTIPLY:
+  case DENSITY_NODE_MIN:
+  case DENSITY_NODE_MAX:
+    return 2;
+  case DENSITY_NODE_CLAMP:
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+int AddDensityNode(DensityGraph *graph, DensityNode node)
+{
+  if (graph->nodeCount >= DENSITY_GRAPH_MAX_NODES)
+  {
+    TraceLog(LOG_WARNING, "DENSITY: Graph is full, node dropped");
+    return -1;
+  }
+
+  for (int i = 0; i < GetDensityNodeInputCount(node.type); i++)
+  {
+    if (node.inputs[i] < 0 || node.inputs[i] >= graph->nodeCount)
+    {
+      TraceLog(LOG_WARNING, "DENSITY: Node input %d is not an earlier node, node dropped", node.inputs[i]);
+      return -1;
+    }
+  }
+
+  graph->nodes[graph->nodeCount] = node;
+  return graph->nodeCount++;
+}
+
+int AddConstantNode(DensityGraph *graph, float value)
+{
+  return AddDensityNode(graph, (DensityNode){.type = DENSITY_NODE_CONSTANT, .inputs = {-1, -1}, .params = {value}});
+}
+
+int AddInputNode(DensityGraph *graph, DensityNodeType type)
+{
+  return AddDensityNode(graph, (DensityNode){.type = type, .inputs = {-1, -1}});
+}
+
+int AddNoiseNode(DensityGraph *graph, DensityNodeType type, NoiseParams noise)
+{
+  return AddDensityNode(graph, (DensityNode){.type = type, .inputs = {-1, -1}, .noise = noise});
+}
+
+int AddBinaryNode(DensityGraph *graph, DensityNodeType type, int a, int b)
+{
+  return AddDensityNode(graph, (DensityNode){.type = type, .inputs = {a, b}});
+}
+
+int AddScaleNode(DensityGraph *graph, int input, float scale)
+{
+  return AddBinaryNode(graph, DENSITY_NODE_MULTIPLY, input, AddConstantNode(graph, scale));
+}
+
+int AddClampNode(DensityGraph *graph, int input, float min, float max)
+{
+  return AddDensityNode(graph, (DensityNode){.type = DENSITY_NODE_CLAMP, .inputs = {input, -1}, .params = {min, max}});
+}
+
+int AddSphereNode(DensityGraph *graph, Vector3 center, float radius)
+{
+  return AddDensityNode(graph, (DensityNode){.type = DENSITY_NODE_SPHERE, .inputs = {-1, -1}, .params = {center.x, center.y, center.z, radius}});
+}
+
+int AddBoxNode(DensityGraph *graph, Vector3 center, float halfExtent)
+{
+  return AddDensityNode(graph, (DensityNode){.type = DENSITY_NODE_BOX, .inputs = {-1, -1}, .params = {center.x, center.y, center.z, halfExtent}});
+}
+
+int AddFeatureNode(DensityGraph *graph, FeatureGrid features)
+{
+  return AddDensityNode(graph, (DensityNode){.type = DENSITY_NODE_FEATURES, .inputs = {-1, -1}, .features = features});
+}
+
+// Function to fill a block with an input array, or zeros when it is missing
+static void CopyDensityInput(float *values, const float *input, int start, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    values[i] = input ? input[start + i] : 0.0f;
+  }
+}
+
+void EvaluateDensityGraph(const DensityGraph *graph, DensityInputs inputs, float *out, int count, unsigned int seed)
+{
+  float values[DENSITY_GRAPH_MAX_NODES][DENSITY_BLOCK_SIZE];
+  float x[DENSITY_BLOCK_SIZE];
+  float y[DENSITY_BLOCK_SIZE];
+  float z[DENSITY_BLOCK_SIZE];
+
+  if (graph->nodeCount == 0)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      out[i] = 0.0f;
+    }
+    return;
+  }
+
+  for (int start = 0; start < count; start += DENSITY_BLOCK_SIZE)
+  {
+    int block = count - start < DENSITY_BLOCK_SIZE ? count - start : DENSITY_BLOCK_SIZE;
+    CopyDensityInput(x, inputs.x, start, block);
+    CopyDensityInput(y, inputs.y, start, block);
+    CopyDensityInput(z, inputs.z, start, block);
+
+    for (int n = 0; n < graph->nodeCount; n++)
+    {
+      const DensityNode *node = &graph->nodes[n];
+      const float *a = node->inputs[0] >= 0 ? values[node->inputs[0]] : NULL;
+      const float *b = node->inputs[1] >= 0 ? values[node->inputs[1]] : NULL;
+      float *v = values[n];
+
+      switch (node->type)
+      {
+      case DENSITY_NODE_CONSTANT:
+        for (int i = 0; i < block; i++)
+          v[i] = node->params[0];
+        break;
+      case DENSITY_NODE_X:
+        CopyDensityInput(v, x, 0, block);
+        break;
+      case DENSITY_NODE_Y:
+        CopyDensityInput(v, y, 0, block);
+        break;
+      case DENSITY_NODE_Z:
+        CopyDensityInput(v, z, 0, block);
+        break;
+      case DENSITY_NODE_HEIGHT:
+        CopyDensityInput(v, inputs.height, start, block);
+        break;
+      case DENSITY_NODE_FBM:
+      case DENSITY_NODE_RIDGED:
+      {
+        NoiseParams noise = node->noise;
+        noise.seed += seed * 0x9E3779B1u;
+        if (node->type == DENSITY_NODE_FBM)
+          FbmNoise2DBatch(x, z, v, block, &noise);
+        else
+          RidgedNoise2DBatch(x, z, v, block, &noise);
+        break;
+      }
+      case DENSITY_NODE_ADD:
+        for (int i = 0; i < block; i++)
+          v[i] = a[i] + b[i];
+        break;
+      case DENSITY_NODE_SUBTRACT:
+        for (int i = 0; i < block; i++)
+          v[i] = a[i] - b[i];
+        break;
+      case DENSITY_NODE_MULTIPLY:
+        for (int i = 0; i < block; i++)
+          v[i] = a[i] * b[i];
+        break;
+      case DENSITY_NODE_MIN:
+        for (int i = 0; i < block; i++)
+          v[i] = a[i] < b[i] ? a[i] : b[i];
+        break;
+      case DENSITY_NODE_MAX:
+        for (int i = 0; i < block; i++)
+          v[i] = a[i] > b[i] ? a[i] : b[i];
+        break;
+      case DENSITY_NODE_CLAMP:
+        for (int i = 0; i < block; i++)
+          v[i] = a[i] < node->params[0] ? node->params[0] : (a[i] > node->params[1] ? node->params[1] : a[i]);
+        break;
+      case DENSITY_NODE_SPHERE:
+        for (int i = 0; i < block; i++)
+        {
+          float dx = x[i] - node->params[0];
+          float dy = y[i] - node->params[1];
+          float dz = z[i] - node->params[2];
+          v[i] = sqrtf(dx * dx + dy * dy + dz * dz) - node->params[3];
+        }
+        break;
+      case DENSITY_NODE_BOX:
+        for (int i = 0; i < block; i++)
+        {
+          // Exact distance outside the box, distance to the nearest face inside
+          float qx = fabsf(x[i] - node->params[0]) - node->params[3];
+          float qy = fabsf(y[i] - node->params[1]) - node->params[3];
+          float qz = fabsf(z[i] - node->params[2]) - node->params[3];
+          float ox = qx > 0.0f ? qx : 0.0f;
+          float oy = qy > 0.0f ? qy : 0.0f;
+          float oz = qz > 0.0f ? qz : 0.0f;
+          float inside = fmaxf(qx, fmaxf(qy, qz));
+          v[i] = sqrtf(ox * ox + oy * oy + oz * oz) + (inside < 0.0f ? inside : 0.0f);
+        }
+        break;
+      case DENSITY_NODE_FEATURES:
+        EvaluateFeatureHeights(&node->features, x, z, v, block);
+        break;
+      }
+    }
+
+    const float *result = values[graph->nodeCount - 1];
+    for (int i = 0; i < block; i++)
+    {
+      out[start + i] = result[i];
+    }
+  }
+}
+
+// Function to get the signed distance from a point to a box of the given half extent
+static float GetBoxDistance(Vector3 point, Vector3 center, float halfExtent)
+{
+  float qx = fabsf(point.x - center.x) - halfExtent;
+  float qy = fabsf(point.y - center.y) - halfExtent;
+  float qz = fabsf(point.z - center.z) - halfExtent;
+  float ox = fmaxf(qx, 0.0f);
+  float oy = fmaxf(qy, 0.0f);
+  float oz = fmaxf(qz, 0.0f);
+  return sqrtf(ox * ox + oy * oy + oz * oz) + fminf(fmaxf(qx, fmaxf(qy, qz)), 0.0f);
+}
+
+DensityRange BoundDensityGraph(const DensityGraph *graph, DensityRegion region)
+{
+  DensityRange ranges[DENSITY_GRAPH_MAX_NODES];
+  if (graph->nodeCount == 0)
+    return (DensityRange){0.0f, 0.0f};
+
+  Vector3 center = Vector3Scale(Vector3Add(region.min, region.max), 0.5f);
+  float halfDiagonal = Vector3Length(Vector3Subtract(region.max, center));
+
+  for (int n = 0; n < graph->nodeCount; n++)
+  {
+    const DensityNode *node = &graph->nodes[n];
+    DensityRange a = node->inputs[0] >= 0 ? ranges[node->inputs[0]] : (DensityRange){0};
+    DensityRange b = node->inputs[1] >= 0 ? ranges[node->inputs[1]] : (DensityRange){0};
+    DensityRange *r = &ranges[n];
+
+    switch (node->type)
+    {
+    case DENSITY_NODE_CONSTANT:
+      *r = (DensityRange){node->params[0], node->params[0]};
+      break;
+    case DENSITY_NODE_X:
+      *r = (DensityRange){region.min.x, region.max.x};
+      break;
+    case DENSITY_NODE_Y:
+      *r = (DensityRange){region.min.y, region.max.y};
+      break;
+    case DENSITY_NODE_Z:
+      *r = (DensityRange){region.min.z, region.max.z};
+      break;
+    case DENSITY_NODE_HEIGHT:
+      *r = (DensityRange){region.minHeight, region.maxHeight};
+      break;
+    case DENSITY_NODE_FBM:
+      *r = (DensityRange){-1.0f - DENSITY_BOUND_SLACK, 1.0f + DENSITY_BOUND_SLACK};
+      break;
+    case DENSITY_NODE_RIDGED:
+      *r = (DensityRange){-DENSITY_BOUND_SLACK, 1.0f + DENSITY_BOUND_SLACK};
+      break;
+    case DENSITY_NODE_ADD:
+      *r = (DensityRange){a.min + b.min, a.max + b.max};
+      break;
+    case DENSITY_NODE_SUBTRACT:
+      *r = (DensityRange){a.min - b.max, a.max - b.min};
+      break;
+    case DENSITY_NODE_MULTIPLY:
+    {
+      float p0 = a.min * b.min;
+      float p1 = a.min * b.max;
+      float p2 = a.max * b.min;
+      float p3 = a.max * b.max;
+      *r = (DensityRange){fminf(fminf(p0, p1), fminf(p2, p3)), fmaxf(fmaxf(p0, p1), fmaxf(p2, p3))};
+      break;
+    }
+    case DENSITY_NODE_MIN:
+      *r = (DensityRange){fminf(a.min, b.min), fminf(a.max, b.max)};
+      break;
+    case DENSITY_NODE_MAX:
+      *r = (DensityRange){fmaxf(a.min, b.min), fmaxf(a.max, b.max)};
+      break;
+    case DENSITY_NODE_CLAMP:
+      *r = (DensityRange){Clamp(a.min, node->params[0], node->params[1]), Clamp(a.max, node->params[0], node->params[1])};
+      break;
+    case DENSITY_NODE_SPHERE:
+    case DENSITY_NODE_BOX:
+    {
+      // Signed distances change by at most the distance moved, so bound them from the region center
+      Vector3 shapeCenter = {node->params[0], node->params[1], node->params[2]};
+      float distance = node->type == DENSITY_NODE_SPHERE
+                           ? Vector3Distance(center, shapeCenter) - node->params[3]
+                           : GetBoxDistance(center, shapeCenter, node->params[3]);
+      *r = (DensityRange){distance - halfDiagonal - DENSITY_BOUND_SLACK, distance + halfDiagonal + DENSITY_BOUND_SLACK};
+      break;
+    }
+    case DENSITY_NODE_FEATURES:
+      GetFeatureHeightRange(&node->features, region.min.x, region.min.z, region.max.x, region.max.z, &r->min, &r->max);
+      r->min -= DENSITY_BOUND_SLACK;
+      r->max += DENSITY_BOUND_SLACK;
+      break;
+    }
+  }
+
+  return ranges[graph->nodeCount - 1];
+}
@@ -0,0 +1,99 @@
+#ifndef DENSITY_GRAPH_H
+#define DENSITY_GRAPH_H
+
+#include "raylib.h"
+#include "noise.h"
+#include "feature_grid.h"
+
+// Maximum nodes in one graph, graphs are fixed size so they can be copied by value
+#define DENSITY_GRAPH_MAX_NODES 32
+
+// Positions evaluated per pass, every node runs one loop over a block
+#define DENSITY_BLOCK_SIZE 64
+
+typedef enum
+{
+  DENSITY_NODE_CONSTANT, // params[0]
+  DENSITY_NODE_X,        // World x of the position
+  DENSITY_NODE_Y,        // World y of the position
+  DENSITY_NODE_Z,        // World z of the position
+  DENSITY_NODE_HEIGHT,   // Column height from the heightfield stage, 0 while it is being generated
+  DENSITY_NODE_FBM,      // FbmNoise2DBatch over x and z
+  DENSITY_NODE_RIDGED,   // RidgedNoise2DBatch over x and z
+  DENSITY_NODE_ADD,      // inputs[0] + inputs[1]
+  DENSITY_NODE_SUBTRACT, // inputs[0] - inputs[1]
+  DENSITY_NODE_MULTIPLY, // inputs[0] * inputs[1]
+  DENSITY_NODE_MIN,      // Union of two signed distances
+  DENSITY_NODE_MAX,      // Intersection of two signed distances
+  DENSITY_NODE_CLAMP,    // inputs[0] clamped to [params[0], params[1]]
+  DENSITY_NODE_SPHERE,   // Signed distance to a sphere, center params[0..2], radius params[3]
+  DENSITY_NODE_BOX,      // Signed distance to a box, center params[0..2], half extent params[3]
+  DENSITY_NODE_FEATURES, // Summed height offset of the features of a feature grid over x and z
+} DensityNodeType;
+
+typedef struct
+{
+  DensityNodeType type;
+  int inputs[2];        // Earlier nodes of the graph, -1 when unused
+  float params[4];      // Meaning depends on the type
+  NoiseParams noise;    // Noise nodes only, the world seed is mixed into noise.seed
+  FeatureGrid features; // Feature nodes only, shared by copies of the graph and freed by its builder
+} DensityNode;
+
+// Nodes in evaluation order, every node only reads nodes added before it, the last node is the output
+typedef struct
+{
+  DensityNode nodes[DENSITY_GRAPH_MAX_NODES];
+  int nodeCount;
+} DensityGraph;
+
+// Positions of one evaluation, arrays that are NULL read as 0
+typedef struct
+{
+  const float *x;
+  const float *y;
+  const float *z;
+  const float *height;
+} DensityInputs;
+
+// Axis-aligned box of positions, with the range of the column heights above it
+typedef struct
+{
+  Vector3 min;
+  Vector3 max;
+  float minHeight;
+  float maxHeight;
+} DensityRegion;
+
+// Conservative range of a graph value
+typedef struct
+{
+  float min;
+  float max;
+} DensityRange;
+
+// Function to create an empty graph
+DensityGraph InitializeDensityGraph(void);
+
+// Function to append a node, returns its index or -1 when the graph is full or an input is invalid
+int AddDensityNode(DensityGraph *graph, DensityNode node);
+
+// Node helpers, each returns the index of the new node or -1
+int AddConstantNode(DensityGraph *graph, float value);
+int AddInputNode(DensityGraph *graph, DensityNodeType type);
+int AddNoiseNode(DensityGraph *graph, DensityNodeType type, NoiseParams noise);
+int AddBinaryNode(DensityGraph *graph, DensityNodeType type, int a, int b);
+int AddScaleNode(DensityGraph *graph, int input, float scale);
+int AddClampNode(DensityGraph *graph, int input, float min, float max);
+int AddSphereNode(DensityGraph *graph, Vector3 center, float radius);
+int AddBoxNode(DensityGraph *graph, Vector3 center, float halfExtent);
+
+int AddFeatureNode(DensityGraph *graph, FeatureGrid features);
+
+// Function to evaluate the output node of a graph at count positions
+void EvaluateDensityGraph(const DensityGraph *graph, DensityInputs inputs, float *out, int count, unsigned int seed);
+
+// Function to get a conservative range of the output of a graph over a region, by interval arithmetic
+DensityRange BoundDensityGraph(const DensityGraph *graph, DensityRegion region);
+
+#endif // DENSITY_GRAPH_H
@@ -0,0 +1,222 @@
+#include "feature_grid.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Fraction of a plateau radius that slopes down to the surrounding terrain
+#define PLATEAU_SLOPE_WIDTH 0.3f
+
+// Function to get the clamped cell range covered by a feature along one axis
+static void GetFeatureCellRange(float center, float radius, float origin, float cellSize, int cells, int *first, int *last)
+{
+  *first = (int)floorf((center - radius - origin) / cellSize);
+  *last = (int)floorf((center + radius - origin) / cellSize);
+  *first = *first < 0 ? 0 : *first;
+  *last = *last > cells - 1 ? cells - 1 : *last;
+}
+
+FeatureGrid InitializeFeatureGrid(const TerrainFeature *features, int featureCount, float cellSize)
+{
+  FeatureGrid grid = {0};
+  if (featureCount <= 0 || cellSize <= 0.0f)
+    return grid;
+
+  // Grid bounds cover the bounds of every feature
+  float minX = features[0].x - features[0].radius;
+  float minZ = features[0].z - features[0].radius;
+  float maxX = features[0].x + features[0].radius;
+  float maxZ = features[0].z + features[0].radius;
+  for (int i = 1; i < featureCount; i++)
+  {
+    minX = fminf(minX, features[i].x - features[i].radius);
+    minZ = fminf(minZ, features[i].z - features[i].radius);
+    maxX = fmaxf(maxX, features[i].x + features[i].radius);
+    maxZ = fmaxf(maxZ, features[i].z + features[i].radius);
+  }
+
+  grid.originX = minX;
+  grid.originZ = minZ;
+  grid.cellSize = cellSize;
+  grid.cellsX = (int)floorf((maxX - minX) / cellSize) + 1;
+  grid.cellsZ = (int)floorf((maxZ - minZ) / cellSize) + 1;
+  int cellCount = grid.cellsX * grid.cellsZ;
+
+  grid.features = (TerrainFeature *)RL_MALLOC(featureCount * sizeof(TerrainFeature));
+  grid.cellStarts = (int *)RL_CALLOC(cellCount + 1, sizeof(int));
+  if (!grid.features || !grid.cellStarts)
+  {
+    CleanupFeatureGrid(&grid);
+    return grid;
+  }
+  memcpy(grid.features, features, featureCount * sizeof(TerrainFeature));
+  grid.featureCount = featureCount;
+
+  // Count the entries of every cell, then turn the counts into offsets
+  for (int i = 0; i < featureCount; i++)
+  {
+    int firstX, lastX, firstZ, lastZ;
+    GetFeatureCellRange(features[i].x, features[i].radius, grid.originX, cellSize, grid.cellsX, &firstX, &lastX);
+    GetFeatureCellRange(features[i].z, features[i].radius, grid.originZ, cellSize, grid.cellsZ, &firstZ, &lastZ);
+    for (int cx = firstX; cx <= lastX; cx++)
+    {
+      for (int cz = firstZ; cz <= lastZ; cz++)
+      {
+        grid.cellStarts[cx * grid.cellsZ + cz + 1]++;
+      }
+    }
+  }
+  for (int c = 0; c < cellCount; c++)
+  {
+    grid.cellStarts[c + 1] += grid.cellStarts[c];
+  }
+
+  grid.cellFeatures = (int *)RL_MALLOC((grid.cellStarts[cellCount] > 0 ? grid.cellStarts[cellCount] : 1) * sizeof(int));
+  int *cellFill = (int *)RL_MALLOC(cellCount * sizeof(int));
+  if (!grid.cellFeatures || !cellFill)
+  {
+    RL_FREE(cellFill);
+    CleanupFeatureGrid(&grid);
+    return grid;
+  }
+  memcpy(cellFill, grid.cellStarts, cellCount * sizeof(int));
+
+  // Fill in feature order, so every cell sums its features in the same order as a full scan
+  for (int i = 0; i < featureCount; i++)
+  {
+    int firstX, lastX, firstZ, lastZ;
+    GetFeatureCellRange(features[i].x, features[i].radius, grid.originX, cellSize, grid.cellsX, &firstX, &lastX);
+    GetFeatureCellRange(features[i].z, features[i].radius, grid.originZ, cellSize, grid.cellsZ, &firstZ, &lastZ);
+    for (int cx = firstX; cx <= lastX; cx++)
+    {
+      for (int cz = firstZ; cz <= lastZ; cz++)
+      {
+        grid.cellFeatures[cellFill[cx * grid.cellsZ + cz]++] = i;
+      }
+    }
+  }
+  RL_FREE(cellFill);
+
+  return grid;
+}
+
+void CleanupFeatureGrid(FeatureGrid *grid)
+{
+  RL_FREE(grid->features);
+  RL_FREE(grid->cellStarts);
+  RL_FREE(grid->cellFeatures);
+  *grid = (FeatureGrid){0};
+}
+
+// Function to hash a feature index into [0, 1)
+static float GetFeatureRandom(unsigned int seed, unsigned int index, unsigned int channel)
+{
+  unsigned int hash = seed * 0x9E3779B1u ^ index * 0x85EBCA77u ^ channel * 0xC2B2AE3Du;
+  hash ^= hash >> 16;
+  hash *= 0x7FEB352Du;
+  hash ^= hash >> 15;
+  hash *= 0x846CA68Bu;
+  hash ^= hash >> 16;
+  return (hash >> 8) * (1.0f / 16777216.0f);
+}
+
+int ScatterTerrainFeatures(TerrainFeature *features, int count, TerrainFeatureType type, unsigned int seed,
+                           Rectangle area, float minRadius, float maxRadius, float minHeight, float maxHeight)
+{
+  for (int i = 0; i < count; i++)
+  {
+    // Small features are more common than large ones
+    float size = GetFeatureRandom(seed, i, 2);
+    size *= size;
+
+    features[i] = (TerrainFeature){
+        .type = type,
+        .x = area.x + GetFeatureRandom(seed, i, 0) * area.width,
+        .z = area.y + GetFeatureRandom(seed, i, 1) * area.height,
+        .radius = minRadius + size * (maxRadius - minRadius),
+        .height = minHeight + size * (maxHeight - minHeight)};
+  }
+  return count;
+}
+
+// Function to get the height offset of one feature at a distance from its center, inside its radius
+static float GetFeatureHeight(const TerrainFeature *feature, float distance)
+{
+  float normalizedDist = distance / feature->radius;
+  switch (feature->type)
+  {
+  case TERRAIN_FEATURE_CRATER:
+    return -(float)(sin(normalizedDist * 3.14159f) * feature->height);
+  case TERRAIN_FEATURE_PLATEAU:
+  {
+    float slope = (1.0f - normalizedDist) / PLATEAU_SLOPE_WIDTH;
+    return feature->height * (slope < 1.0f ? slope : 1.0f);
+  }
+  }
+  return 0.0f;
+}
+
+void EvaluateFeatureHeights(const FeatureGrid *grid, const float *x, const float *z, float *out, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    out[i] = 0.0f;
+    if (grid->featureCount == 0)
+      continue;
+
+    int cx = (int)floorf((x[i] - grid->originX) / grid->cellSize);
+    int cz = (int)floorf((z[i] - grid->originZ) / grid->cellSize);
+    if (cx < 0 || cx >= grid->cellsX || cz < 0 || cz >= grid->cellsZ)
+      continue;
+
+    int cell = cx * grid->cellsZ + cz;
+    for (int e = grid->cellStarts[cell]; e < grid->cellStarts[cell + 1]; e++)
+    {
+      const TerrainFeature *feature = &grid->features[grid->cellFeatures[e]];
+
+      float dx = x[i] - feature->x;
+      float dz = z[i] - feature->z;
+      float distance = sqrt(dx * dx + dz * dz);
+      if (distance < feature->radius)
+        out[i] += GetFeatureHeight(feature, distance);
+    }
+  }
+}
+
+void GetFeatureHeightRange(const FeatureGrid *grid, float minX, float minZ, float maxX, float maxZ, float *minHeight, float *maxHeight)
+{
+  *minHeight = 0.0f;
+  *maxHeight = 0.0f;
+  if (grid->featureCount == 0)
+    return;
+
+  int firstX, lastX, firstZ, lastZ;
+  GetFeatureCellRange((minX + maxX) * 0.5f, (maxX - minX) * 0.5f, grid->originX, grid->cellSize, grid->cellsX, &firstX, &lastX);
+  GetFeatureCellRange((minZ + maxZ) * 0.5f, (maxZ - minZ) * 0.5f, grid->originZ, grid->cellSize, grid->cellsZ, &firstZ, &lastZ);
+
+  for (int cx = firstX; cx <= lastX; cx++)
+  {
+    for (int cz = firstZ; cz <= lastZ; cz++)
+    {
+      int cell = cx * grid->cellsZ + cz;
+      for (int e = grid->cellStarts[cell]; e < grid->cellStarts[cell + 1]; e++)
+      {
+        const TerrainFeature *feature = &grid->features[grid->cellFeatures[e]];
+        if (feature->x + feature->radius < minX || feature->x - feature->radius > maxX ||
+            feature->z + feature->radius < minZ || feature->z - feature->radius > maxZ)
+          continue;
+
+        // Count a feature only in the first cell of the rectangle it shares
+        int featureFirstX, featureLastX, featureFirstZ, featureLastZ;
+        GetFeatureCellRange(feature->x, feature->radius, grid->originX, grid->cellSize, grid->cellsX, &featureFirstX, &featureLastX);
+        GetFeatureCellRange(feature->z, feature->radius, grid->originZ, grid->cellSize, grid->cellsZ, &featureFirstZ, &featureLastZ);
+        if (cx != (featureFirstX > firstX ? featureFirstX : firstX) || cz != (featureFirstZ > firstZ ? featureFirstZ : firstZ))
+          continue;
+
+        if (feature->type == TERRAIN_FEATURE_CRATER)
+          *minHeight -= feature->height;
+        else
+          *maxHeight += feature->height;
+      }
+    }
+  }
+}
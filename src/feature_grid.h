@@ -0,0 +1,50 @@
+#ifndef FEATURE_GRID_H
+#define FEATURE_GRID_H
+
+#include "raylib.h"
+
+typedef enum
+{
+  TERRAIN_FEATURE_CRATER,  // Bowl with a raised rim, height is the rim depth
+  TERRAIN_FEATURE_PLATEAU, // Flat-topped rise with sloped edges, height is the rise
+} TerrainFeatureType;
+
+// Procedural feature that offsets terrain height within radius of its center
+typedef struct
+{
+  TerrainFeatureType type;
+  float x;
+  float z;
+  float radius;
+  float height;
+} TerrainFeature;
+
+// Features bucketed by 2D cell, each cell lists the features whose bounds overlap it in feature order
+typedef struct
+{
+  TerrainFeature *features;
+  int featureCount;
+  int *cellStarts;   // First entry of every cell in cellFeatures, cellsX * cellsZ + 1 entries
+  int *cellFeatures; // Feature indices of all cells
+  float originX;
+  float originZ;
+  float cellSize;
+  int cellsX;
+  int cellsZ;
+} FeatureGrid;
+
+// Feature grid management, the features are copied into the grid
+FeatureGrid InitializeFeatureGrid(const TerrainFeature *features, int featureCount, float cellSize);
+void CleanupFeatureGrid(FeatureGrid *grid);
+
+// Function to place count features of a type at seeded random positions inside area (x and z), returns count
+int ScatterTerrainFeatures(TerrainFeature *features, int count, TerrainFeatureType type, unsigned int seed,
+                           Rectangle area, float minRadius, float maxRadius, float minHeight, float maxHeight);
+
+// Function to get the summed height offset of the features at count positions
+void EvaluateFeatureHeights(const FeatureGrid *grid, const float *x, const float *z, float *out, int count);
+
+// Function to get a conservative range of the summed feature heights over an xz rectangle
+void GetFeatureHeightRange(const FeatureGrid *grid, float minX, float minZ, float maxX, float maxZ, float *minHeight, float *maxHeight);
+
+#endif // FEATURE_GRID_H
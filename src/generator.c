@@ -0,0 +1,354 @@
+#include "generator.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Cell size of the feature grids, about the diameter of a typical scattered feature
+#define FEATURE_CELL_SIZE 16.0f
+
+// Scattered features of the moon preset
+#define MOON_CRATER_COUNT 2000
+#define MOON_PLATEAU_COUNT 40
+
+// Function to add the stock height layers to a graph: FBM hills, FBM mountain ranges and ridged crests
+static int AddStockHeightLayers(DensityGraph *graph)
+{
+  NoiseParams hills = {.seed = 0, .frequency = 0.03f, .lacunarity = 2.2f, .gain = 0.45f, .octaves = 5};
+  NoiseParams mountains = {.seed = 100, .frequency = 0.008f, .lacunarity = 2.0f, .gain = 0.5f, .octaves = 2};
+  NoiseParams ridges = {.seed = 200, .frequency = 0.02f, .lacunarity = 2.0f, .gain = 0.5f, .octaves = 3};
+
+  int height = AddConstantNode(graph, -5.0f); // Start below zero for more valleys
+  height = AddBinaryNode(graph, DENSITY_NODE_ADD, height, AddScaleNode(graph, AddNoiseNode(graph, DENSITY_NODE_FBM, hills), 60.0f));
+  height = AddBinaryNode(graph, DENSITY_NODE_ADD, height, AddScaleNode(graph, AddNoiseNode(graph, DENSITY_NODE_FBM, mountains), 35.0f));
+  height = AddBinaryNode(graph, DENSITY_NODE_ADD, height, AddScaleNode(graph, AddNoiseNode(graph, DENSITY_NODE_RIDGED, ridges), 6.0f));
+  return height;
+}
+
+// Function to make valleys more common by scaling positive heights by 0.8 and negative ones by 1.2
+static int AddValleyCurve(DensityGraph *graph, int height)
+{
+  int zero = AddConstantNode(graph, 0.0f);
+  int peaks = AddScaleNode(graph, AddBinaryNode(graph, DENSITY_NODE_MAX, height, zero), 0.8f);
+  int valleys = AddScaleNode(graph, AddBinaryNode(graph, DENSITY_NODE_MIN, height, zero), 1.2f);
+  return AddBinaryNode(graph, DENSITY_NODE_ADD, peaks, valleys);
+}
+
+// Rolling hills and mountains with craters, the stock world
+static TerrainParams GetHillsPreset(void)
+{
+  TerrainParams params = {.baseY = -CHUNK_SIZE / 2.0f, .height = InitializeDensityGraph(), .density = InitializeDensityGraph()};
+  DensityGraph *graph = &params.height;
+
+  // Five craters on a ring around the world center
+  TerrainFeature craters[5];
+  for (int c = 0; c < 5; c++)
+  {
+    craters[c] = (TerrainFeature){
+        .type = TERRAIN_FEATURE_CRATER,
+        .x = sin(c * 1.1f) * 80.0f,
+        .z = cos(c * 1.1f) * 80.0f,
+        .radius = 20.0f + c * 4.0f,
+        .height = 12.0f};
+  }
+
+  int height = AddStockHeightLayers(graph);
+  height = AddBinaryNode(graph, DENSITY_NODE_ADD, height, AddFeatureNode(graph, InitializeFeatureGrid(craters, 5, FEATURE_CELL_SIZE)));
+  height = AddValleyCurve(graph, height);
+  AddBinaryNode(graph, DENSITY_NODE_ADD, height, AddConstantNode(graph, -8.0f)); // Lower the base level
+  return params;
+}
+
+// Flat-topped islands in a low basin
+static TerrainParams GetIslandsPreset(void)
+{
+  TerrainParams params = {.baseY = -CHUNK_SIZE / 2.0f, .height = InitializeDensityGraph(), .density = InitializeDensityGraph()};
+  DensityGraph *graph = &params.height;
+  NoiseParams land = {.seed = 300, .frequency = 0.012f, .lacunarity = 2.0f, .gain = 0.5f, .octaves = 4};
+  NoiseParams detail = {.seed = 400, .frequency = 0.05f, .lacunarity = 2.0f, .gain = 0.5f, .octaves = 3};
+
+  int height = AddScaleNode(graph, AddNoiseNode(graph, DENSITY_NODE_FBM, land), 90.0f);
+  height = AddClampNode(graph, height, -25.0f, 10.0f);
+  height = AddBinaryNode(graph, DENSITY_NODE_ADD, height, AddScaleNode(graph, AddNoiseNode(graph, DENSITY_NODE_FBM, detail), 6.0f));
+  AddBinaryNode(graph, DENSITY_NODE_ADD, height, AddConstantNode(graph, -6.0f));
+  return params;
+}
+
+// Stock hills with rock formations floating above them
+static TerrainParams GetFloatingPreset(void)
+{
+  TerrainParams params = GetHillsPreset();
+  DensityGraph *graph = &params.density;
+
+  // Density of heightfield terrain is the height above the surface
+  int density = AddBinaryNode(graph, DENSITY_NODE_SUBTRACT, AddInputNode(graph, DENSITY_NODE_Y), AddInputNode(graph, DENSITY_NODE_HEIGHT));
+  density = AddBinaryNode(graph, DENSITY_NODE_MIN, density, AddSphereNode(graph, (Vector3){-60.0f, 16.0f, -40.0f}, 10.0f));
+  density = AddBinaryNode(graph, DENSITY_NODE_MIN, density, AddSphereNode(graph, (Vector3){45.0f, 20.0f, 30.0f}, 8.0f));
+  density = AddBinaryNode(graph, DENSITY_NODE_MIN, density, AddSphereNode(graph, (Vector3){-10.0f, 18.0f, 70.0f}, 12.0f));
+  AddBinaryNode(graph, DENSITY_NODE_MIN, density, AddBoxNode(graph, (Vector3){70.0f, 16.0f, -70.0f}, 7.0f));
+  return params;
+}
+
+// Gently rolling ground covered in craters and a few plateaus
+static TerrainParams GetMoonPreset(void)
+{
+  TerrainParams params = {.baseY = -CHUNK_SIZE / 2.0f, .height = InitializeDensityGraph(), .density = InitializeDensityGraph()};
+  DensityGraph *graph = &params.height;
+  NoiseParams ground = {.seed = 500, .frequency = 0.01f, .lacunarity = 2.0f, .gain = 0.5f, .octaves = 3};
+
+  // Cover a little more than the stock world so craters also cut its edges
+  Rectangle area = {-140.0f, -140.0f, 280.0f, 280.0f};
+  TerrainFeature *features = (TerrainFeature *)RL_MALLOC((MOON_CRATER_COUNT + MOON_PLATEAU_COUNT) * sizeof(TerrainFeature));
+  if (features)
+  {
+    ScatterTerrainFeatures(features, MOON_CRATER_COUNT, TERRAIN_FEATURE_CRATER, 1, area, 1.5f, 12.0f, 0.5f, 5.0f);
+    ScatterTerrainFeatures(features + MOON_CRATER_COUNT, MOON_PLATEAU_COUNT, TERRAIN_FEATURE_PLATEAU, 2, area, 8.0f, 20.0f, 4.0f, 10.0f);
+  }
+
+  int height = AddScaleNode(graph, AddNoiseNode(graph, DENSITY_NODE_FBM, ground), 20.0f);
+  if (features)
+  {
+    FeatureGrid grid = InitializeFeatureGrid(features, MOON_CRATER_COUNT + MOON_PLATEAU_COUNT, FEATURE_CELL_SIZE);
+    height = AddBinaryNode(graph, DENSITY_NODE_ADD, height, AddFeatureNode(graph, grid));
+    RL_FREE(features);
+  }
+  AddBinaryNode(graph, DENSITY_NODE_ADD, height, AddConstantNode(graph, -10.0f));
+  return params;
+}
+
+TerrainParams GetDefaultTerrainParams(void)
+{
+  return GetHillsPreset();
+}
+
+TerrainParams GetTerrainPreset(const char *name)
+{
+  if (strcmp(name, "islands") == 0)
+    return GetIslandsPreset();
+  if (strcmp(name, "floating") == 0)
+    return GetFloatingPreset();
+  if (strcmp(name, "moon") == 0)
+    return GetMoonPreset();
+  if (strcmp(name, "hills") != 0)
+    TraceLog(LOG_WARNING, "TERRAIN: Unknown preset \"%s\", using \"hills\"", name);
+  return GetHillsPreset();
+}
+
+// Function to free the feature grids of a graph
+static void CleanupDensityGraphFeatures(DensityGraph *graph)
+{
+  for (int n = 0; n < graph->nodeCount; n++)
+  {
+    if (graph->nodes[n].type == DENSITY_NODE_FEATURES)
+      CleanupFeatureGrid(&graph->nodes[n].features);
+  }
+}
+
+void CleanupTerrainParams(TerrainParams *params)
+{
+  CleanupDensityGraphFeatures(&params->height);
+  CleanupDensityGraphFeatures(&params->density);
+}
+
+void GenerateChunkHeightfield(ChunkHeightfield *heightfield, Vector3 position, unsigned int seed, const TerrainParams *params)
+{
+  heightfield->minHeight = 1000.0f;
+  heightfield->maxHeight = -1000.0f;
+
+  float worldX[CHUNK_SIZE];
+  float worldZ[CHUNK_SIZE];
+
+  for (int vx = 0; vx < CHUNK_SIZE; vx++)
+  {
+    // Evaluate the height graph for a whole line of columns at once
+    for (int vz = 0; vz < CHUNK_SIZE; vz++)
+    {
+      worldX[vz] = position.x + vx * VOXEL_SIZE;
+      worldZ[vz] = position.z + vz * VOXEL_SIZE;
+    }
+    DensityInputs inputs = {.x = worldX, .z = worldZ};
+    EvaluateDensityGraph(&params->height, inputs, heightfield->heights[vx], CHUNK_SIZE, seed);
+
+    // Track height range
+    for (int vz = 0; vz < CHUNK_SIZE; vz++)
+    {
+      float height = heightfield->heights[vx][vz];
+      if (height > heightfield->maxHeight)
+        heightfield->maxHeight = height;
+      if (height < heightfield->minHeight)
+        heightfield->minHeight = height;
+    }
+  }
+}
+
+// Function to evaluate and store every voxel of one brick, returns false when a voxel write was dropped
+static bool FillBrickDensity(Chunk *chunk, const ChunkHeightfield *heightfield, const TerrainParams *params, unsigned int seed, int x0, int y0, int z0)
+{
+  float worldX[BRICK_SIZE * BRICK_SIZE];
+  float worldY[BRICK_SIZE * BRICK_SIZE];
+  float worldZ[BRICK_SIZE * BRICK_SIZE];
+  float heights[BRICK_SIZE * BRICK_SIZE];
+  float densities[BRICK_SIZE * BRICK_SIZE];
+
+  // Evaluate one y-z slice of the brick per pass
+  for (int vx = x0; vx < x0 + BRICK_SIZE; vx++)
+  {
+    for (int j = 0; j < BRICK_SIZE * BRICK_SIZE; j++)
+    {
+      int vy = y0 + j / BRICK_SIZE;
+      int vz = z0 + j % BRICK_SIZE;
+      worldX[j] = chunk->position.x + vx * VOXEL_SIZE;
+      worldY[j] = params->baseY + vy * VOXEL_SIZE;
+      worldZ[j] = chunk->position.z + vz * VOXEL_SIZE;
+      heights[j] = heightfield->heights[vx][vz];
+    }
+
+    if (params->density.nodeCount > 0)
+    {
+      DensityInputs inputs = {.x = worldX, .y = worldY, .z = worldZ, .height = heights};
+      EvaluateDensityGraph(&params->density, inputs, densities, BRICK_SIZE * BRICK_SIZE, seed);
+    }
+    else
+    {
+      for (int j = 0; j < BRICK_SIZE * BRICK_SIZE; j++)
+      {
+        densities[j] = worldY[j] - heights[j];
+      }
+    }
+
+    for (int j = 0; j < BRICK_SIZE * BRICK_SIZE; j++)
+    {
+      // Make density binary (-1 or 1) for blocky terrain
+      float density = densities[j] <= 0.0f ? -1.0f : 1.0f;
+      if (!SetChunkVoxel(chunk, vx, y0 + j / BRICK_SIZE, z0 + j % BRICK_SIZE, DensityToVoxel(density)))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool FillChunkDensity(Chunk *chunk, const ChunkHeightfield *heightfield, const TerrainParams *params, unsigned int seed)
+{
+  Voxel solid = DensityToVoxel(-1.0f);
+  Voxel air = DensityToVoxel(1.0f);
+
+  for (int bx = 0; bx < BRICKS_PER_AXIS; bx++)
+  {
+    for (int bz = 0; bz < BRICKS_PER_AXIS; bz++)
+    {
+      int x0 = bx * BRICK_SIZE;
+      int z0 = bz * BRICK_SIZE;
+
+      // Surface height range over the columns of this brick column
+      float minHeight = heightfield->heights[x0][z0];
+      float maxHeight = minHeight;
+      for (int vx = x0; vx < x0 + BRICK_SIZE; vx++)
+      {
+        for (int vz = z0; vz < z0 + BRICK_SIZE; vz++)
+        {
+          minHeight = fminf(minHeight, heightfield->heights[vx][vz]);
+          maxHeight = fmaxf(maxHeight, heightfield->heights[vx][vz]);
+        }
+      }
+
+      for (int by = 0; by < BRICKS_PER_AXIS; by++)
+      {
+        int y0 = by * BRICK_SIZE;
+        DensityRegion region = {
+            .min = {chunk->position.x + x0 * VOXEL_SIZE, params->baseY + y0 * VOXEL_SIZE, chunk->position.z + z0 * VOXEL_SIZE},
+            .max = {chunk->position.x + (x0 + BRICK_SIZE - 1) * VOXEL_SIZE, params->baseY + (y0 + BRICK_SIZE - 1) * VOXEL_SIZE,
+                    chunk->position.z + (z0 + BRICK_SIZE - 1) * VOXEL_SIZE},
+            .minHeight = minHeight,
+            .maxHeight = maxHeight};
+
+        DensityRange range;
+        if (params->density.nodeCount > 0)
+          range = BoundDensityGraph(&params->density, region);
+        else
+          range = (DensityRange){region.min.y - maxHeight, region.max.y - minHeight};
+
+        // Bricks that are certainly all solid or all air are filled without evaluating their voxels
+        if (range.max <= 0.0f)
+          SetChunkBrickUniform(chunk, bx, by, bz, solid);
+        else if (range.min > 0.0f)
+          SetChunkBrickUniform(chunk, bx, by, bz, air);
+        else if (!FillBrickDensity(chunk, heightfield, params, seed, x0, y0, z0))
+          return false;
+      }
+    }
+  }
+
+  UpdateBrickSummaries(chunk, 0, 0, 0, CHUNK_SIZE - 1, CHUNK_SIZE - 1, CHUNK_SIZE - 1);
+  return true;
+}
+
+bool GenerateChunkDensity(Chunk *chunk, unsigned int seed, const TerrainParams *params, ChunkHeightfield *heightfield)
+{
+  ChunkHeightfield scratch;
+  if (!heightfield)
+    heightfield = &scratch;
+
+  GenerateChunkHeightfield(heightfield, chunk->position, seed, params);
+  return FillChunkDensity(chunk, heightfield, params, seed);
+}
+
+bool GenerateChunkPreview(Chunk *preview, Vector3 position, unsigned int seed, const TerrainParams *params)
+{
+  const int samples = SECTION_SIZE + 1;
+  const float spacing = CHUNK_PREVIEW_STEP * VOXEL_SIZE;
+
+  InitializeChunk(preview, position);
+
+  float worldX[SECTION_SIZE + 1];
+  float worldY[SECTION_SIZE + 1];
+  float worldZ[SECTION_SIZE + 1];
+  float heights[SECTION_SIZE + 1];
+  float densities[SECTION_SIZE + 1];
+
+  for (int px = 0; px < samples; px++)
+  {
+    // Sample the height graph on every CHUNK_PREVIEW_STEP-th column of this line
+    float lineHeights[SECTION_SIZE + 1];
+    for (int pz = 0; pz < samples; pz++)
+    {
+      worldX[pz] = position.x + px * spacing;
+      worldZ[pz] = position.z + pz * spacing;
+    }
+    DensityInputs lineInputs = {.x = worldX, .z = worldZ};
+    EvaluateDensityGraph(&params->height, lineInputs, lineHeights, samples, seed);
+
+    // Evaluate one vertical line of preview voxels per pass
+    for (int pz = 0; pz < samples; pz++)
+    {
+      for (int py = 0; py < samples; py++)
+      {
+        worldX[py] = position.x + px * spacing;
+        worldY[py] = params->baseY + py * spacing;
+        worldZ[py] = position.z + pz * spacing;
+        heights[py] = lineHeights[pz];
+      }
+
+      if (params->density.nodeCount > 0)
+      {
+        DensityInputs inputs = {.x = worldX, .y = worldY, .z = worldZ, .height = heights};
+        EvaluateDensityGraph(&params->density, inputs, densities, samples, seed);
+      }
+      else
+      {
+        for (int py = 0; py < samples; py++)
+        {
+          densities[py] = worldY[py] - heights[py];
+        }
+      }
+
+      for (int py = 0; py < samples; py++)
+      {
+        float density = densities[py] <= 0.0f ? -1.0f : 1.0f;
+        if (!SetChunkVoxel(preview, px, py, pz, DensityToVoxel(density)))
+          return false;
+      }
+    }
+  }
+
+  UpdateBrickSummaries(preview, 0, 0, 0, SECTION_SIZE, SECTION_SIZE, SECTION_SIZE);
+  return true;
+}
@@ -0,0 +1,39 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "chunk.h"
+#include "density_graph.h"
+
+// Terrain shape as density graphs, see GetTerrainPreset for the built-in worlds
+typedef struct
+{
+  float baseY;          // World height of the bottom voxel layer of a chunk
+  DensityGraph height;  // Column height, evaluated once per column on x and z
+  DensityGraph density; // Voxel density, negative inside, empty for plain heightfield terrain
+} TerrainParams;
+
+// Function to get the terrain parameters of the stock world, the "hills" preset
+TerrainParams GetDefaultTerrainParams(void);
+
+// Function to get a built-in terrain preset by name ("hills", "islands", "floating" or "moon"), unknown names give the stock world
+TerrainParams GetTerrainPreset(const char *name);
+
+// Function to free the feature grids of terrain parameters, copies made earlier must no longer be used
+void CleanupTerrainParams(TerrainParams *params);
+
+// Function to evaluate the height graph once per column of the chunk at position
+void GenerateChunkHeightfield(ChunkHeightfield *heightfield, Vector3 position, unsigned int seed, const TerrainParams *params);
+
+// Function to fill a chunk from its heightfield and the density graph, then update its brick summaries
+// Returns false when a voxel write was dropped for lack of memory, the chunk is then only partly filled
+bool FillChunkDensity(Chunk *chunk, const ChunkHeightfield *heightfield, const TerrainParams *params, unsigned int seed);
+
+// Function to generate the heightfield and densities of a chunk, heightfield may be NULL when not needed afterwards
+// Returns false when the chunk could not be filled completely, see FillChunkDensity
+bool GenerateChunkDensity(Chunk *chunk, unsigned int seed, const TerrainParams *params, ChunkHeightfield *heightfield);
+
+// Function to fill a coarse preview of the chunk at position, voxels CHUNK_PREVIEW_STEP apart in its first section
+// Returns false when the preview could not be filled completely
+bool GenerateChunkPreview(Chunk *preview, Vector3 position, unsigned int seed, const TerrainParams *params);
+
+#endif // GENERATOR_H
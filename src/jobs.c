@@ -0,0 +1,447 @@
+#include "jobs.h"
+#include "raylib.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+// Declared here because windows.h clashes with raylib.h
+#define JOBS_ALL_PROCESSOR_GROUPS 0xFFFF
+__declspec(dllimport) unsigned long __stdcall GetActiveProcessorCount(unsigned short groupNumber);
+#else
+#include <unistd.h>
+#endif
+
+#define JOB_DEQUE_INITIAL_CAPACITY 64
+
+// Tasks a parallel for is split into per thread, so threads that finish early can steal the rest
+#define PARALLEL_FOR_TASKS_PER_THREAD 4
+#define PARALLEL_FOR_MAX_TASKS 256
+
+typedef struct
+{
+  JobFunction function;
+  void *data;
+  JobCounter *counter; // NULL when the job is not counted
+} Job;
+
+// Jobs queued by one thread, the owner pushes and pops at the back, other threads steal from the front
+typedef struct
+{
+  pthread_mutex_t mutex;
+  Job *jobs; // Ring buffer
+  int capacity;
+  int head;
+  int count;
+} JobDeque;
+
+struct JobQueue
+{
+  JobDeque *deques; // One per worker, the last one is shared by the threads outside the pool
+  int dequeCount;
+  atomic_int queued;         // Jobs waiting in any deque
+  atomic_int unfinished;     // Queued plus running jobs
+  atomic_int sleeping;       // Workers waiting for jobAvailable
+  atomic_int startedWorkers; // Hands out the worker deques
+  pthread_mutex_t sleepMutex;
+  pthread_cond_t jobAvailable; // Signaled when a job is queued or on shutdown
+  pthread_cond_t jobsDone;     // Broadcast when a counter or the whole queue runs out of jobs
+  bool shutdown;
+  pthread_t *threads;
+};
+
+// Job system the calling thread works for and its deque there, only set on workers
+static _Thread_local JobQueue *workerQueue = NULL;
+static _Thread_local int workerDeque = -1;
+
+int GetProcessorCount(void)
+{
+#if defined(_WIN32)
+  long count = (long)GetActiveProcessorCount(JOBS_ALL_PROCESSOR_GROUPS);
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  return count > 0 ? (int)count : 1;
+}
+
+// Function to get the deque jobs submitted by the calling thread go to
+static JobDeque *GetThreadDeque(JobQueue *queue)
+{
+  return &queue->deques[workerQueue == queue ? workerDeque : queue->dequeCount - 1];
+}
+
+// Function to add a job at the back of a deque, returns false when it cannot grow
+static bool PushJob(JobDeque *deque, Job job)
+{
+  pthread_mutex_lock(&deque->mutex);
+
+  // Grow the ring buffer, unwrapping it into the new storage
+  if (deque->count == deque->capacity)
+  {
+    Job *grown = (Job *)RL_MALLOC(deque->capacity * 2 * sizeof(Job));
+    if (!grown)
+    {
+      pthread_mutex_unlock(&deque->mutex);
+      return false;
+    }
+
+    for (int i = 0; i < deque->count; i++)
+    {
+      grown[i] = deque->jobs[(deque->head + i) % deque->capacity];
+    }
+    RL_FREE(deque->jobs);
+    deque->jobs = grown;
+    deque->head = 0;
+    deque->capacity *= 2;
+  }
+
+  deque->jobs[(deque->head + deque->count) % deque->capacity] = job;
+  deque->count++;
+
+  pthread_mutex_unlock(&deque->mutex);
+  return true;
+}
+
+// Function to take the newest job of a deque, or with a counter the newest job of that counter
+static bool PopJob(JobDeque *deque, const JobCounter *counter, Job *job)
+{
+  bool found = false;
+  pthread_mutex_lock(&deque->mutex);
+
+  for (int i = deque->count - 1; i >= 0; i--)
+  {
+    Job *candidate = &deque->jobs[(deque->head + i) % deque->capacity];
+    if (counter && candidate->counter != counter)
+      continue;
+
+    *job = *candidate;
+
+    // Close the gap, jobs behind it move one slot forward
+    for (int j = i; j < deque->count - 1; j++)
+    {
+      deque->jobs[(deque->head + j) % deque->capacity] = deque->jobs[(deque->head + j + 1) % deque->capacity];
+    }
+    deque->count--;
+    found = true;
+    break;
+  }
+
+  pthread_mutex_unlock(&deque->mutex);
+  return found;
+}
+
+// Function to take the oldest job of another thread's deque
+static bool StealJob(JobDeque *deque, Job *job)
+{
+  bool found = false;
+  pthread_mutex_lock(&deque->mutex);
+
+  if (deque->count > 0)
+  {
+    *job = deque->jobs[deque->head];
+    deque->head = (deque->head + 1) % deque->capacity;
+    deque->count--;
+    found = true;
+  }
+
+  pthread_mutex_unlock(&deque->mutex);
+  return found;
+}
+
+// Function to take a job from the calling thread's deque, or steal one from the other deques
+static bool TakeJob(JobQueue *queue, Job *job)
+{
+  if (atomic_load(&queue->queued) <= 0)
+    return false;
+
+  JobDeque *own = GetThreadDeque(queue);
+  int start = (int)(own - queue->deques);
+  bool found = PopJob(own, NULL, job);
+
+  for (int i = 1; i < queue->dequeCount && !found; i++)
+  {
+    found = StealJob(&queue->deques[(start + i) % queue->dequeCount], job);
+  }
+
+  if (found)
+    atomic_fetch_sub(&queue->queued, 1);
+  return found;
+}
+
+// Function to wake the threads waiting in WaitForCounter or WaitForJobs
+static void NotifyJobsDone(JobQueue *queue)
+{
+  pthread_mutex_lock(&queue->sleepMutex);
+  pthread_cond_broadcast(&queue->jobsDone);
+  pthread_mutex_unlock(&queue->sleepMutex);
+}
+
+// Function to run a taken job and record its completion
+static void RunJob(JobQueue *queue, Job job)
+{
+  job.function(job.data);
+
+  // The counter may be released by its waiter as soon as it reaches zero
+  bool counterDone = job.counter && atomic_fetch_sub(&job.counter->pending, 1) == 1;
+  bool queueDone = atomic_fetch_sub(&queue->unfinished, 1) == 1;
+  if (counterDone || queueDone)
+    NotifyJobsDone(queue);
+}
+
+static void *WorkerThread(void *argument)
+{
+  JobQueue *queue = (JobQueue *)argument;
+  workerQueue = queue;
+  workerDeque = atomic_fetch_add(&queue->startedWorkers, 1);
+
+  while (true)
+  {
+    Job job;
+    if (TakeJob(queue, &job))
+    {
+      RunJob(queue, job);
+      continue;
+    }
+
+    // Sleep until a job is queued, workers drain the deques before they see the shutdown flag
+    pthread_mutex_lock(&queue->sleepMutex);
+    atomic_fetch_add(&queue->sleeping, 1);
+    while (atomic_load(&queue->queued) <= 0 && !queue->shutdown)
+      pthread_cond_wait(&queue->jobAvailable, &queue->sleepMutex);
+    atomic_fetch_sub(&queue->sleeping, 1);
+    bool exit = queue->shutdown && atomic_load(&queue->queued) <= 0;
+    pthread_mutex_unlock(&queue->sleepMutex);
+
+    if (exit)
+      break;
+  }
+
+  return NULL;
+}
+
+JobSystem InitializeJobSystem(int threadCount)
+{
+  JobSystem jobs = {0};
+  if (threadCount == JOBS_SINGLE_THREADED)
+  {
+    TraceLog(LOG_INFO, "JOBS: Single-threaded, jobs run inline on submit");
+    return jobs;
+  }
+  if (threadCount <= 0)
+    threadCount = GetProcessorCount();
+
+  JobQueue *queue = (JobQueue *)RL_CALLOC(1, sizeof(JobQueue));
+  if (!queue)
+    return jobs;
+
+  queue->dequeCount = threadCount + 1;
+  queue->deques = (JobDeque *)RL_CALLOC(queue->dequeCount, sizeof(JobDeque));
+  queue->threads = (pthread_t *)RL_MALLOC(threadCount * sizeof(pthread_t));
+  bool allocated = queue->deques && queue->threads;
+  for (int i = 0; allocated && i < queue->dequeCount; i++)
+  {
+    queue->deques[i].jobs = (Job *)RL_MALLOC(JOB_DEQUE_INITIAL_CAPACITY * sizeof(Job));
+    queue->deques[i].capacity = JOB_DEQUE_INITIAL_CAPACITY;
+    allocated = queue->deques[i].jobs != NULL;
+  }
+
+  if (!allocated)
+  {
+    for (int i = 0; queue->deques && i < queue->dequeCount; i++)
+    {
+      RL_FREE(queue->deques[i].jobs);
+    }
+    RL_FREE(queue->deques);
+    RL_FREE(queue->threads);
+    RL_FREE(queue);
+    return jobs;
+  }
+
+  for (int i = 0; i < queue->dequeCount; i++)
+  {
+    pthread_mutex_init(&queue->deques[i].mutex, NULL);
+  }
+  pthread_mutex_init(&queue->sleepMutex, NULL);
+  pthread_cond_init(&queue->jobAvailable, NULL);
+  pthread_cond_init(&queue->jobsDone, NULL);
+  jobs.queue = queue;
+
+  for (int i = 0; i < threadCount; i++)
+  {
+    if (pthread_create(&queue->threads[i], NULL, WorkerThread, queue) != 0)
+      break;
+    jobs.threadCount++;
+  }
+
+  TraceLog(LOG_INFO, "JOBS: Started %d worker threads", jobs.threadCount);
+  return jobs;
+}
+
+void CleanupJobSystem(JobSystem *jobs)
+{
+  JobQueue *queue = jobs->queue;
+  if (!queue)
+    return;
+
+  pthread_mutex_lock(&queue->sleepMutex);
+  queue->shutdown = true;
+  pthread_cond_broadcast(&queue->jobAvailable);
+  pthread_mutex_unlock(&queue->sleepMutex);
+
+  for (int i = 0; i < jobs->threadCount; i++)
+  {
+    pthread_join(queue->threads[i], NULL);
+  }
+
+  pthread_cond_destroy(&queue->jobsDone);
+  pthread_cond_destroy(&queue->jobAvailable);
+  pthread_mutex_destroy(&queue->sleepMutex);
+  for (int i = 0; i < queue->dequeCount; i++)
+  {
+    pthread_mutex_destroy(&queue->deques[i].mutex);
+    RL_FREE(queue->deques[i].jobs);
+  }
+  RL_FREE(queue->deques);
+  RL_FREE(queue->threads);
+  RL_FREE(queue);
+
+  jobs->queue = NULL;
+  jobs->threadCount = 0;
+}
+
+void SubmitJob(JobSystem *jobs, JobFunction function, void *data)
+{
+  SubmitCountedJob(jobs, function, data, NULL);
+}
+
+void SubmitCountedJob(JobSystem *jobs, JobFunction function, void *data, JobCounter *counter)
+{
+  JobQueue *queue = jobs ? jobs->queue : NULL;
+  if (!queue || jobs->threadCount == 0)
+  {
+    function(data);
+    return;
+  }
+
+  Job job = {function, data, counter};
+  if (counter)
+    atomic_fetch_add(&counter->pending, 1);
+  atomic_fetch_add(&queue->unfinished, 1);
+  atomic_fetch_add(&queue->queued, 1);
+
+  if (!PushJob(GetThreadDeque(queue), job))
+  {
+    atomic_fetch_sub(&queue->queued, 1);
+    RunJob(queue, job);
+    return;
+  }
+
+  // Pairs with the sleeping count workers publish before checking queued
+  if (atomic_load(&queue->sleeping) > 0)
+  {
+    pthread_mutex_lock(&queue->sleepMutex);
+    pthread_cond_signal(&queue->jobAvailable);
+    pthread_mutex_unlock(&queue->sleepMutex);
+  }
+}
+
+void WaitForCounter(JobSystem *jobs, JobCounter *counter)
+{
+  JobQueue *queue = jobs ? jobs->queue : NULL;
+  if (!queue)
+    return;
+
+  while (atomic_load(&counter->pending) > 0)
+  {
+    // Only run jobs of this counter, a long unrelated job would delay the caller
+    Job job;
+    if (PopJob(GetThreadDeque(queue), counter, &job))
+    {
+      atomic_fetch_sub(&queue->queued, 1);
+      RunJob(queue, job);
+      continue;
+    }
+
+    // The rest was stolen, wait for the thieves to finish it
+    pthread_mutex_lock(&queue->sleepMutex);
+    while (atomic_load(&counter->pending) > 0)
+      pthread_cond_wait(&queue->jobsDone, &queue->sleepMutex);
+    pthread_mutex_unlock(&queue->sleepMutex);
+  }
+}
+
+void WaitForJobs(JobSystem *jobs)
+{
+  JobQueue *queue = jobs ? jobs->queue : NULL;
+  if (!queue)
+    return;
+
+  while (atomic_load(&queue->unfinished) > 0)
+  {
+    Job job;
+    if (TakeJob(queue, &job))
+    {
+      RunJob(queue, job);
+      continue;
+    }
+
+    pthread_mutex_lock(&queue->sleepMutex);
+    if (atomic_load(&queue->unfinished) > 0 && atomic_load(&queue->queued) <= 0)
+      pthread_cond_wait(&queue->jobsDone, &queue->sleepMutex);
+    pthread_mutex_unlock(&queue->sleepMutex);
+  }
+}
+
+// Contiguous run of ParallelFor3D items
+typedef struct
+{
+  ParallelForFunction function;
+  void *data;
+  int countY;
+  int countZ;
+  int begin; // Flattened item indices [begin, end), x slowest
+  int end;
+} ParallelForTask;
+
+static void ParallelForJob(void *data)
+{
+  ParallelForTask *task = (ParallelForTask *)data;
+  for (int i = task->begin; i < task->end; i++)
+  {
+    task->function(task->data, i / (task->countY * task->countZ), (i / task->countZ) % task->countY, i % task->countZ);
+  }
+}
+
+void ParallelFor3D(JobSystem *jobs, int countX, int countY, int countZ, ParallelForFunction function, void *data)
+{
+  int total = countX * countY * countZ;
+  if (countX <= 0 || countY <= 0 || countZ <= 0)
+    return;
+
+  // Without workers every item runs here, in order
+  int taskCount = 1;
+  if (jobs && jobs->queue && jobs->threadCount > 0)
+    taskCount = (jobs->threadCount + 1) * PARALLEL_FOR_TASKS_PER_THREAD;
+  taskCount = taskCount < total ? taskCount : total;
+  taskCount = taskCount < PARALLEL_FOR_MAX_TASKS ? taskCount : PARALLEL_FOR_MAX_TASKS;
+
+  ParallelForTask tasks[PARALLEL_FOR_MAX_TASKS];
+  for (int t = 0; t < taskCount; t++)
+  {
+    tasks[t] = (ParallelForTask){
+        .function = function,
+        .data = data,
+        .countY = countY,
+        .countZ = countZ,
+        .begin = (int)((long long)total * t / taskCount),
+        .end = (int)((long long)total * (t + 1) / taskCount)};
+  }
+
+  // Queue the later runs and start on the first one here
+  JobCounter counter = {0};
+  for (int t = 1; t < taskCount; t++)
+  {
+    SubmitCountedJob(jobs, ParallelForJob, &tasks[t], &counter);
+  }
+  ParallelForJob(&tasks[0]);
+  WaitForCounter(jobs, &counter);
+}
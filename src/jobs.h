@@ -0,0 +1,55 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+// Thread count that runs every job inline on submit, in submission order, for debugging
+#define JOBS_SINGLE_THREADED -1
+
+// Function run by a job, data is owned by the submitter and must outlive the job
+typedef void (*JobFunction)(void *data);
+
+// Function run by ParallelFor3D once per item of the range
+typedef void (*ParallelForFunction)(void *data, int x, int y, int z);
+
+// Jobs of a group still to finish, zero-initialize before submitting and wait on it with WaitForCounter
+typedef struct
+{
+  atomic_int pending;
+} JobCounter;
+
+// Deques and worker state, heap allocated so workers keep a stable pointer
+typedef struct JobQueue JobQueue;
+
+// Work-stealing thread pool, every worker has its own deque and steals from the others when it runs dry
+typedef struct
+{
+  JobQueue *queue;
+  int threadCount; // Worker threads, 0 when jobs run inline on submit
+} JobSystem;
+
+// Function to get the number of logical processors
+int GetProcessorCount(void);
+
+// Job system management, threadCount 0 starts one worker per logical processor
+JobSystem InitializeJobSystem(int threadCount);
+void CleanupJobSystem(JobSystem *jobs);
+
+// Function to queue a job on the calling thread's deque, it runs inline when there are no workers
+void SubmitJob(JobSystem *jobs, JobFunction function, void *data);
+
+// Function to queue a job that counter tracks, counter may be NULL
+void SubmitCountedJob(JobSystem *jobs, JobFunction function, void *data, JobCounter *counter);
+
+// Function to wait until the jobs of a counter have finished, the calling thread runs the ones it queued itself
+void WaitForCounter(JobSystem *jobs, JobCounter *counter);
+
+// Function to wait until every submitted job has finished, the calling thread helps run them
+void WaitForJobs(JobSystem *jobs);
+
+// Function to call function for every (x, y, z) below the counts across the workers and the calling thread, returns when all calls are done
+// Items are split in contiguous runs with x slowest, jobs may be NULL to run them all on the calling thread
+void ParallelFor3D(JobSystem *jobs, int countX, int countY, int countZ, ParallelForFunction function, void *data);
+
+#endif // JOBS_H
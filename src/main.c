@@ -5,6 +5,13 @@
 #include "marching_cubes.h"
 #include "terrain.h"
 #include "render.h"
+#include "generator.h"
+#include "jobs.h"
+#include "remesh.h"
+#include "pipeline.h"
+#include "upload_budget.h"
+#include "world_mesh.h"
+#include "mesh_pool.h"
 #include <stdlib.h>
 #include <math.h>
 
@@ -17,7 +24,7 @@
 #define MAX_RAY_DISTANCE 100.0f
 #define CROSSHAIR_SIZE 10
 #define CROSSHAIR_THICKNESS 2
-#define MESH_UPDATE_DELAY 0.01f
+#define TERRAIN_SEED 0
 
 // Camera settings
 #define CAMERA_MOVE_SPEED 30.0f
@@ -47,7 +54,13 @@ typedef struct
 
 extern ChunkData chunks[CHUNKS_X][CHUNKS_Z];
 
-int main(void)
+// Function to draw the full-resolution chunks and the previews of the chunks still generating
+static void DrawTerrainScene(void *data)
+{
+  DrawWorldMesh((WorldMesh *)data);
+}
+
+int main(int argc, char *argv[])
 {
   // Window dimensions
   const int screenWidth = 800;
@@ -84,131 +97,83 @@ int main(void)
   Material material = LoadMaterialDefault();
   material.shader = renderContext.lightingShader; // Use the shader from render context
 
-  // Initialize chunks
-  float globalMinHeight = 1000.0f;
-  float globalMaxHeight = -1000.0f;
-
+  // Generate chunk densities in the background, coarse previews are drawn until each chunk is ready
+  // Set RAYM_SINGLE_THREADED to run every job inline on this thread, in a fixed order, for debugging
+  JobSystem jobSystem = InitializeJobSystem(getenv("RAYM_SINGLE_THREADED") ? JOBS_SINGLE_THREADED : 0);
+  renderContext.jobSystem = &jobSystem;
+  // Terrain preset from the command line, e.g. "marching_cubes islands"
+  TerrainParams terrainParams = argc > 1 ? GetTerrainPreset(argv[1]) : GetDefaultTerrainParams();
+  double generationStart = GetTime();
+
+  // Chunk geometry, previews included, shares a few large GPU buffers and is drawn in one pass per buffer
+  WorldMesh worldMesh = InitializeWorldMesh(material);
+
+  // Previews sample every CHUNK_PREVIEW_STEP-th voxel, cheap enough to build before the first frame
+  // They are meshed with this thread's meshing context, the one inline jobs use too
+  MeshingContext *meshingContext = GetThreadMeshingContext();
+  Chunk preview;
   for (int x = 0; x < CHUNKS_X; x++)
   {
     for (int z = 0; z < CHUNKS_Z; z++)
     {
       chunks[x][z].initialized = false;
       chunks[x][z].needsUpdate = false;
-      chunks[x][z].updateTimer = 0.0f;
-      chunks[x][z].minHeight = 1000.0f;
-      chunks[x][z].maxHeight = -1000.0f;
-      chunks[x][z].chunk.position = (Vector3){
+      chunks[x][z].remeshing = false;
+      Vector3 chunkPosition = {
           x * (CHUNK_SIZE - 1) - ((CHUNKS_X * (CHUNK_SIZE - 1)) / 2.0f),
           0.0f,
           z * (CHUNK_SIZE - 1) - ((CHUNKS_Z * (CHUNK_SIZE - 1)) / 2.0f)};
+      InitializeChunk(&chunks[x][z].chunk, chunkPosition);
 
-      // Initialize voxel data for each chunk
-      for (int vx = 0; vx < CHUNK_SIZE; vx++)
-      {
-        for (int vy = 0; vy < CHUNK_SIZE; vy++)
-        {
-          for (int vz = 0; vz < CHUNK_SIZE; vz++)
-          {
-            Vector3 worldPos = GetWorldPosition(x, z, vx, vy, vz);
-
-            // Multi-octave noise for more natural terrain
-            float frequency = 0.03f; // Lower frequency for larger features
-            float amplitude = 14.0f; // Increased amplitude for more height variation
-            float height = -5.0f;    // Start below zero for more valleys
-            int octaves = 5;         // More octaves for more detail
-
-            // Add large-scale mountain ranges
-            float mountainNoise = sin(worldPos.x * 0.01f) * cos(worldPos.z * 0.01f) * 15.0f;
-
-            // Create some ridges and valleys
-            float ridgeNoise = fabs(sin(worldPos.x * 0.03f + worldPos.z * 0.02f)) * 10.0f;
-
-            // Basic Perlin-like noise for the terrain
-            for (int o = 0; o < octaves; o++)
-            {
-              float noiseX = worldPos.x * frequency;
-              float noiseZ = worldPos.z * frequency;
-
-              height += sinf(noiseX) * cosf(noiseZ) * amplitude;
-              height += sinf(noiseX * 1.5f + cosf(noiseZ * 0.8f)) * amplitude * 0.5f;
+      // The whole preview fits in the first section
+      // A preview that could not be filled is left out, the chunk shows up once the pipeline has generated it
+      bool previewFilled = GenerateChunkPreview(&preview, chunkPosition, TERRAIN_SEED, &terrainParams);
+      SectionMeshData previewMesh = {0};
+      if (previewFilled && meshingContext)
+        previewMesh = BuildSectionMesh(meshingContext, &preview, 0, 0, 0);
+      UpdateChunkPreviewMesh(&worldMesh, &chunks[x][z], &previewMesh);
+      CleanupChunk(&preview);
+    }
+  }
 
-              // Reduce amplitude and increase frequency for each octave
-              amplitude *= 0.45f;
-              frequency *= 2.2f;
-            }
+  TraceLog(LOG_INFO, "TERRAIN: Previewed %d chunks in %.1f ms", CHUNKS_X * CHUNKS_Z,
+           (GetTime() - generationStart) * 1000.0);
 
-            // Create some crater-like formations
-            float craterNoise = 0.0f;
-            int numCraters = 5;
-            for (int c = 0; c < numCraters; c++)
-            {
-              // Create fixed crater positions
-              float craterX = sin(c * 1.1f) * 80.0f;
-              float craterZ = cos(c * 1.1f) * 80.0f;
-              float craterRadius = 20.0f + c * 4.0f;
-
-              // Calculate distance to crater center
-              float dx = worldPos.x - craterX;
-              float dz = worldPos.z - craterZ;
-              float distToCrater = sqrt(dx * dx + dz * dz);
-
-              // Apply crater depression based on distance
-              if (distToCrater < craterRadius)
-              {
-                float craterDepth = 12.0f;
-                float normalizedDist = distToCrater / craterRadius;
-                float craterShape = sin(normalizedDist * 3.14159f) * craterDepth;
-                craterNoise -= craterShape;
-              }
-            }
+  // Full-resolution chunks go through the generate, mesh and upload stages, replacing their previews
+  ChunkPipeline chunkPipeline = InitializeChunkPipeline(&jobSystem, &worldMesh, &terrainParams, TERRAIN_SEED, 0);
 
-            // Add some random variation for smaller details
-            height += sinf(worldPos.x * 0.15f + worldPos.z * 0.2f) * 4.0f;
-            height += cosf(worldPos.x * 0.2f + worldPos.z * 0.15f) * 3.0f;
+  // Order the chunks by distance to the camera, so the nearest ones reach full resolution first
+  int generationOrder[CHUNKS_X * CHUNKS_Z];
+  float generationDistances[CHUNKS_X * CHUNKS_Z];
+  for (int i = 0; i < CHUNKS_X * CHUNKS_Z; i++)
+  {
+    Vector3 position = chunks[i / CHUNKS_Z][i % CHUNKS_Z].chunk.position;
+    Vector2 center = {position.x + (CHUNK_SIZE - 1) / 2.0f, position.z + (CHUNK_SIZE - 1) / 2.0f};
+    float distance = Vector2DistanceSqr(center, (Vector2){camera.position.x, camera.position.z});
 
-            // Combine all terrain features
-            height += mountainNoise;
-            height += ridgeNoise * 0.5f;
-            height += craterNoise;
+    // Insertion sort, there are only a few chunks
+    int j = i;
+    for (; j > 0 && generationDistances[j - 1] > distance; j--)
+    {
+      generationOrder[j] = generationOrder[j - 1];
+      generationDistances[j] = generationDistances[j - 1];
+    }
+    generationOrder[j] = i;
+    generationDistances[j] = distance;
+  }
 
-            // Make valleys more common by pushing down higher areas
-            if (height > 0)
-            {
-              height *= 0.8f; // Reduce positive heights
-            }
-            else
-            {
-              height *= 1.2f; // Exaggerate negative heights
-            }
+  for (int i = 0; i < CHUNKS_X * CHUNKS_Z; i++)
+  {
+    RequestChunk(&chunkPipeline, &chunks[generationOrder[i] / CHUNKS_Z][generationOrder[i] % CHUNKS_Z]);
+  }
 
-            height -= 8.0f; // Lower the base level
-            float density = worldPos.y - height;
-            // Make density binary (-1 or 1) for blocky terrain
-            density = density <= 0.0f ? -1.0f : 1.0f;
-            chunks[x][z].chunk.voxels[vx][vy][vz].density = density;
-
-            // Track height range
-            if (-height > chunks[x][z].maxHeight)
-              chunks[x][z].maxHeight = -height;
-            if (-height < chunks[x][z].minHeight)
-              chunks[x][z].minHeight = -height;
-          }
-        }
-      }
+  int chunksReady = 0;
 
-      // Update global height range
-      if (chunks[x][z].maxHeight > globalMaxHeight)
-        globalMaxHeight = chunks[x][z].maxHeight;
-      if (chunks[x][z].minHeight < globalMinHeight)
-        globalMinHeight = chunks[x][z].minHeight;
+  // Edited chunks are meshed on the workers, this thread only uploads the finished sections
+  RemeshService remeshService = InitializeRemeshService(&jobSystem, &worldMesh);
 
-      // Generate mesh and create model for this chunk
-      chunks[x][z].mesh = GenerateChunkMesh(&chunks[x][z].chunk);
-      chunks[x][z].model = LoadModelFromMesh(chunks[x][z].mesh);
-      chunks[x][z].model.materials[0] = material;
-      chunks[x][z].initialized = true;
-    }
-  }
+  // Both upload finished meshes through one per-frame budget, so large edits spread over several frames
+  UploadBudget uploadBudget = InitializeUploadBudget(UPLOAD_BYTES_PER_FRAME, UPLOAD_MS_PER_FRAME);
 
   // Day-night cycle variables
   float timeOfDay = 0.0f; // 0.0 to 1.0 representing time of day
@@ -520,93 +485,54 @@ int main(void)
       Vector2 screenCenter = {screenWidth / 2.0f, screenHeight / 2.0f};
       Ray ray = GetScreenToWorldRay(screenCenter, camera);
 
+      // March the ray through the voxels, skipping bricks that hold only air
       Vector3 hitPoint = {0};
-      bool hit = false;
-      float nearestDistance = MAX_RAY_DISTANCE;
-
-      // Calculate which chunks to check based on ray direction
-      Vector3 rayEnd = Vector3Add(ray.position, Vector3Scale(ray.direction, MAX_RAY_DISTANCE));
-      int startX = (int)((fminf(ray.position.x, rayEnd.x) - EDIT_RADIUS + ((CHUNKS_X * (CHUNK_SIZE - 1)) / 2.0f)) / (CHUNK_SIZE - 1));
-      int endX = (int)((fmaxf(ray.position.x, rayEnd.x) + EDIT_RADIUS + ((CHUNKS_X * (CHUNK_SIZE - 1)) / 2.0f)) / (CHUNK_SIZE - 1));
-      int startZ = (int)((fminf(ray.position.z, rayEnd.z) - EDIT_RADIUS + ((CHUNKS_Z * (CHUNK_SIZE - 1)) / 2.0f)) / (CHUNK_SIZE - 1));
-      int endZ = (int)((fmaxf(ray.position.z, rayEnd.z) + EDIT_RADIUS + ((CHUNKS_Z * (CHUNK_SIZE - 1)) / 2.0f)) / (CHUNK_SIZE - 1));
-
-      // Clamp to valid chunk range
-      startX = startX < 0 ? 0 : startX;
-      endX = endX >= CHUNKS_X ? CHUNKS_X - 1 : endX;
-      startZ = startZ < 0 ? 0 : startZ;
-      endZ = endZ >= CHUNKS_Z ? CHUNKS_Z - 1 : endZ;
-
-      // Only check chunks that the ray might intersect
-      for (int x = startX; x <= endX; x++)
-      {
-        for (int z = startZ; z <= endZ; z++)
-        {
-          if (!chunks[x][z].initialized)
-            continue;
-
-          Matrix transform = MatrixTranslate(
-              chunks[x][z].chunk.position.x,
-              chunks[x][z].chunk.position.y,
-              chunks[x][z].chunk.position.z);
-
-          RayCollision collision = GetRayCollisionMesh(ray, chunks[x][z].mesh, transform);
-
-          if (collision.hit && collision.distance < nearestDistance)
-          {
-            hit = true;
-            nearestDistance = collision.distance;
-            hitPoint = collision.point;
-          }
-        }
-      }
+      bool hit = RaycastTerrain(ray, MAX_RAY_DISTANCE, RAY_STEP, &hitPoint);
 
       if (hit)
       {
         float strength = IsMouseButtonDown(MOUSE_BUTTON_LEFT) ? -EDIT_STRENGTH : EDIT_STRENGTH;
-        ModifyTerrain(hitPoint, EDIT_RADIUS, strength);
+        ModifyTerrain(&jobSystem, hitPoint, EDIT_RADIUS, strength);
       }
     }
 
     // Update meshes for modified chunks
-    bool isModifying = IsMouseButtonDown(MOUSE_BUTTON_LEFT) || IsMouseButtonDown(MOUSE_BUTTON_RIGHT);
-
     for (int x = 0; x < CHUNKS_X; x++)
     {
       for (int z = 0; z < CHUNKS_Z; z++)
       {
-        if (chunks[x][z].needsUpdate)
-        {
-          if (isModifying)
-          {
-            chunks[x][z].updateTimer += deltaTime;
-            if (chunks[x][z].updateTimer < MESH_UPDATE_DELAY)
-              continue;
-          }
+        // Remesh only the sections the edits touched, retried next frame while a request is in flight
+        if (chunks[x][z].needsUpdate && RequestChunkRemesh(&remeshService, &chunks[x][z]))
+          chunks[x][z].needsUpdate = false;
+      }
+    }
 
-          // Update mesh and model
-          UnloadMesh(chunks[x][z].mesh);
-          chunks[x][z].mesh = GenerateChunkMesh(&chunks[x][z].chunk);
-
-          // Update the model's mesh data directly
-          chunks[x][z].model.meshes[0].vertexCount = chunks[x][z].mesh.vertexCount;
-          chunks[x][z].model.meshes[0].triangleCount = chunks[x][z].mesh.triangleCount;
-          chunks[x][z].model.meshes[0].vertices = chunks[x][z].mesh.vertices;
-          chunks[x][z].model.meshes[0].indices = chunks[x][z].mesh.indices;
-          chunks[x][z].model.meshes[0].normals = chunks[x][z].mesh.normals;
-
-          // Upload the new mesh data to GPU
-          UpdateMeshBuffer(chunks[x][z].model.meshes[0], 0, chunks[x][z].mesh.vertices,
-                           chunks[x][z].mesh.vertexCount * 3 * sizeof(float), 0);
-          UpdateMeshBuffer(chunks[x][z].model.meshes[0], 1, chunks[x][z].mesh.normals,
-                           chunks[x][z].mesh.vertexCount * 3 * sizeof(float), 0);
-          UpdateMeshBuffer(chunks[x][z].model.meshes[0], 6, chunks[x][z].mesh.indices,
-                           chunks[x][z].mesh.triangleCount * 3 * sizeof(unsigned short), 0);
+    // Swap in the sections meshed since the last frame, nearest visible chunks first and edits before new chunks
+    BeginUploadFrame(&uploadBudget, camera, (float)screenWidth / screenHeight);
+    ApplyRemeshResults(&remeshService, &uploadBudget);
 
-          chunks[x][z].needsUpdate = false;
-          chunks[x][z].updateTimer = 0.0f;
+    // Advance chunk production, uploads happen here since they need the GL context
+    int chunksUploaded = UpdateChunkPipeline(&chunkPipeline, &uploadBudget);
+    if (chunksUploaded > 0 && (chunksReady += chunksUploaded) == CHUNKS_X * CHUNKS_Z)
+    {
+      int denseBricks = 0;
+      for (int x = 0; x < CHUNKS_X; x++)
+      {
+        for (int z = 0; z < CHUNKS_Z; z++)
+        {
+          denseBricks += GetChunkDenseBrickCount(&chunks[x][z].chunk);
         }
       }
+
+      ChunkPipelineStats stats = GetChunkPipelineStats(&chunkPipeline);
+      TraceLog(LOG_INFO, "TERRAIN: Generated %d chunks in %.1f ms on %d threads", CHUNKS_X * CHUNKS_Z,
+               (GetTime() - generationStart) * 1000.0, jobSystem.threadCount);
+      TraceLog(LOG_INFO, "TERRAIN: Average stage latency: generate %.1f ms, mesh %.1f ms, upload %.1f ms",
+               stats.stages[PIPELINE_STAGE_GENERATE].averageMs, stats.stages[PIPELINE_STAGE_MESH].averageMs,
+               stats.stages[PIPELINE_STAGE_UPLOAD].averageMs);
+      TraceLog(LOG_INFO, "TERRAIN: %d of %d bricks stored densely (%d KB of voxels)", denseBricks,
+               CHUNKS_X * CHUNKS_Z * BRICKS_PER_AXIS * BRICKS_PER_AXIS * BRICKS_PER_AXIS,
+               (int)(denseBricks * sizeof(BrickVoxels) / 1024));
     }
 
     // Update water movement
@@ -687,21 +613,8 @@ int main(void)
       DrawSphere(celestialBodyPos, 2.0f, (Color){220, 220, 255, 255});
     }
 
-    // Render all chunks with SSAO
-    for (int x = 0; x < CHUNKS_X; x++)
-    {
-      for (int z = 0; z < CHUNKS_Z; z++)
-      {
-        if (chunks[x][z].initialized)
-        {
-          chunks[x][z].model.transform = MatrixTranslate(
-              chunks[x][z].chunk.position.x,
-              chunks[x][z].chunk.position.y,
-              chunks[x][z].chunk.position.z);
-          RenderSceneWithSSAO(&renderContext, camera, chunks[x][z].model);
-        }
-      }
-    }
+    // Render all chunks with SSAO in one pass
+    RenderSceneWithSSAO(&renderContext, camera, DrawTerrainScene, &worldMesh);
 
     // Render weather particles
     if (weatherIntensity > 0.0f)
@@ -741,7 +654,7 @@ int main(void)
     }
 
     // Render water last for proper transparency
-    RenderWater(&renderContext, camera, chunks[0][0].model);
+    RenderWater(&renderContext, camera, DrawTerrainScene, &worldMesh);
     EndMode3D();
 
     // Update minimap
@@ -808,6 +721,30 @@ int main(void)
     }
     DrawText(TextFormat("Active Particles: %d", activeParticles), 10, 220, 20, RED);
 
+    // Chunk pipeline load as waiting+running per stage, with the average time a chunk spends in it
+    ChunkPipelineStats pipelineStats = GetChunkPipelineStats(&chunkPipeline);
+    const PipelineStageStats *stages = pipelineStats.stages;
+    DrawText(TextFormat("Chunks: gen %d+%d %.0fms  mesh %d+%d %.0fms  upload %d %.1fms",
+                        stages[PIPELINE_STAGE_GENERATE].waiting, stages[PIPELINE_STAGE_GENERATE].running,
+                        stages[PIPELINE_STAGE_GENERATE].averageMs,
+                        stages[PIPELINE_STAGE_MESH].waiting, stages[PIPELINE_STAGE_MESH].running,
+                        stages[PIPELINE_STAGE_MESH].averageMs,
+                        stages[PIPELINE_STAGE_UPLOAD].waiting, stages[PIPELINE_STAGE_UPLOAD].averageMs),
+             10, 250, 20, RED);
+    DrawText(TextFormat("Uploads: %d KB %.1fms  edits waiting %d", uploadBudget.bytesUsed / 1024, uploadBudget.msUsed,
+                        remeshService.waiting),
+             10, 280, 20, RED);
+    WorldMeshStats worldStats = GetWorldMeshStats(&worldMesh);
+    DrawText(TextFormat("World mesh: %d pages %d+%d sections %d/%d KB  draws %d", worldStats.pageCount,
+                        worldStats.sectionCount, worldStats.previewCount, worldStats.usedBytes / 1024,
+                        worldStats.totalBytes / 1024, worldMesh.drawCalls),
+             10, 310, 20, RED);
+    MeshPoolStats poolStats = GetMeshPoolStats();
+    DrawText(TextFormat("Mesh pool: %d KB used %d KB idle  %.0f%% fragmented  %.0f%% reused",
+                        (int)(poolStats.usedBytes / 1024), (int)(poolStats.freeBytes / 1024),
+                        poolStats.fragmentation * 100.0f, poolStats.reuseRate * 100.0f),
+             10, 340, 20, RED);
+
     // Draw the minimap
     // Calculate player facing angle from camera direction
     Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
@@ -888,20 +825,27 @@ int main(void)
   CleanupWater(&renderContext);
   CleanupRenderContext(&renderContext);
 
-  // Cleanup - unload all chunk meshes and models
+  // Chunks may still be generating or remeshing when the window closes
+  CleanupChunkPipeline(&chunkPipeline);
+  CleanupRemeshService(&remeshService);
+  WaitForJobs(&jobSystem);
+
+  // Cleanup - unload all chunk meshes and previews
   for (int x = 0; x < CHUNKS_X; x++)
   {
     for (int z = 0; z < CHUNKS_Z; z++)
     {
-      if (chunks[x][z].initialized)
-      {
-        UnloadMesh(chunks[x][z].mesh);
-        chunks[x][z].model.materials[0] = (Material){0}; // Clear material before unload
-        UnloadModel(chunks[x][z].model);
-      }
+      UnloadChunkMesh(&worldMesh, &chunks[x][z]);
+      CleanupChunk(&chunks[x][z].chunk);
     }
   }
 
+  CleanupWorldMesh(&worldMesh);
+  TrimMeshPool();
+  CleanupJobSystem(&jobSystem);
+  CleanupThreadMeshingContext(); // Previews, and inline jobs when there are no workers, meshed on this thread
+  CleanupTerrainParams(&terrainParams);
+
   // Unload shared material last
   UnloadMaterial(material);
 
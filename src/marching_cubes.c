@@ -1,10 +1,48 @@
 #include "marching_cubes.h"
 #include "chunk.h"
+#include "mesh_pool.h"
+#include "rlgl.h"
+#include <pthread.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if CHUNK_SIZE > 64
+#error "Sign rows pack one chunk line into 64 bits, CHUNK_SIZE must not exceed 64"
+#endif
+
+#if BRICK_SIZE != 8 || CHUNK_SIZE % BRICK_SIZE != 0
+#error "Sign rows are packed one 8-voxel brick at a time"
+#endif
+
+#if SECTION_SIZE > 16
+#error "A section mesh must fit 16-bit indices, SECTION_SIZE must not exceed 16"
+#endif
+
+#if (CHUNK_SIZE - 1) * CHUNK_POSITION_STEPS > 65535
+#error "Chunk-local vertex positions must fit 16 bits"
+#endif
+
+// GL data types used by the chunk vertex layout
+#ifndef RL_BYTE
+#define RL_BYTE 0x1400 // GL_BYTE
+#endif
+#ifndef RL_UNSIGNED_SHORT
+#define RL_UNSIGNED_SHORT 0x1403 // GL_UNSIGNED_SHORT
+#endif
+
 // Edge table for marching cubes
-static const int edgeTable[256] =
+static const uint16_t edgeTable[256] =
     {
         0x0, 0x109, 0x203, 0x30a, 0x406, 0x50f, 0x605, 0x70c,
         0x80c, 0x905, 0xa0f, 0xb06, 0xc0a, 0xd03, 0xe09, 0xf00,
@@ -40,7 +78,7 @@ static const int edgeTable[256] =
         0x70c, 0x605, 0x50f, 0x406, 0x30a, 0x203, 0x109, 0x0};
 
 // Triangle table for marching cubes
-static const int triTable[256][16] =
+static const int8_t triTable[256][16] =
     {{-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
      {0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
      {0, 1, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
@@ -156,7 +194,7 @@ static const int triTable[256][16] =
      {7, 10, 6, 7, 8, 10, 8, 9, 10, -1, -1, -1, -1, -1, -1, -1},
      {0, 7, 3, 0, 10, 7, 0, 9, 10, 6, 7, 10, -1, -1, -1, -1},
      {10, 6, 7, 1, 10, 7, 1, 7, 8, 1, 8, 0, -1, -1, -1, -1},
-     {10, 6, 7, 1, 7, 10, 1, 8, 7, 1, 0, 8, -1, -1, -1, -1},
+     {10, 6, 7, 10, 7, 1, 1, 7, 3, -1, -1, -1, -1, -1, -1, -1},
      {1, 2, 6, 1, 6, 8, 1, 8, 9, 8, 6, 7, -1, -1, -1, -1},
      {2, 6, 9, 2, 9, 1, 6, 7, 9, 0, 9, 3, 7, 3, 9, -1},
      {7, 8, 0, 7, 0, 6, 6, 0, 2, -1, -1, -1, -1, -1, -1, -1},
@@ -259,7 +297,7 @@ static const int triTable[256][16] =
      {9, 4, 5, 2, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
      {2, 5, 10, 3, 5, 2, 3, 4, 5, 3, 8, 4, -1, -1, -1, -1},
      {5, 10, 2, 5, 2, 4, 4, 2, 0, -1, -1, -1, -1, -1, -1, -1},
-     {3, 10, 2, 3, 5, 10, 3, 8, 5, 4, 5, 8, 0, 1, 9, 8},
+     {3, 10, 2, 3, 5, 10, 3, 8, 5, 4, 5, 8, 0, 1, 9, -1},
      {5, 10, 2, 5, 2, 4, 1, 9, 2, 9, 4, 2, -1, -1, -1, -1},
      {8, 4, 5, 8, 5, 3, 3, 5, 1, -1, -1, -1, -1, -1, -1, -1},
      {0, 4, 5, 1, 0, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
@@ -298,21 +336,47 @@ static const int triTable[256][16] =
      {0, 3, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
      {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}};
 
-// Function to interpolate between two vertices
-Vector3 VertexInterp(float isolevel, Vector3 p1, Vector3 p2, float v1, float v2)
+// Number of triangles produced by each marching cubes case
+static const uint8_t triangleCountTable[256] =
+    {
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 2,
+        1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 3,
+        1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 3,
+        2, 3, 3, 2, 3, 4, 4, 3, 3, 4, 4, 3, 4, 5, 5, 2,
+        1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 3,
+        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 4,
+        2, 3, 3, 4, 3, 4, 2, 3, 3, 4, 4, 5, 4, 5, 3, 2,
+        3, 4, 4, 3, 4, 5, 3, 2, 4, 5, 5, 4, 5, 2, 4, 1,
+        1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 3,
+        2, 3, 3, 4, 3, 4, 4, 5, 3, 2, 4, 3, 4, 3, 5, 2,
+        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 4,
+        3, 4, 4, 3, 4, 5, 5, 4, 4, 3, 5, 2, 5, 4, 2, 1,
+        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 2, 3, 3, 2,
+        3, 4, 4, 5, 4, 5, 5, 2, 4, 3, 5, 4, 3, 2, 4, 1,
+        3, 4, 4, 5, 4, 5, 3, 4, 4, 5, 5, 2, 3, 4, 2, 1,
+        2, 3, 3, 2, 3, 4, 2, 1, 3, 2, 4, 1, 2, 1, 1, 0};
+
+// Function to get how far along an edge the surface crosses, clamped to [0, 1]
+static float GetInterpFactor(float isolevel, float v1, float v2)
 {
   // Handle edge cases more robustly
   const float epsilon = 1e-6f;
   if (fabsf(isolevel - v1) < epsilon)
-    return p1;
+    return 0.0f;
   if (fabsf(isolevel - v2) < epsilon)
-    return p2;
+    return 1.0f;
   if (fabsf(v1 - v2) < epsilon)
-    return p1;
+    return 0.0f;
 
   // Clamp mu to [0,1] to prevent any potential overflow
   float mu = (isolevel - v1) / (v2 - v1);
-  mu = mu < 0.0f ? 0.0f : (mu > 1.0f ? 1.0f : mu);
+  return mu < 0.0f ? 0.0f : (mu > 1.0f ? 1.0f : mu);
+}
+
+// Function to interpolate between two vertices
+Vector3 VertexInterp(float isolevel, Vector3 p1, Vector3 p2, float v1, float v2)
+{
+  float mu = GetInterpFactor(isolevel, v1, v2);
 
   Vector3 p = {
       p1.x + mu * (p2.x - p1.x),
@@ -321,207 +385,525 @@ Vector3 VertexInterp(float isolevel, Vector3 p1, Vector3 p2, float v1, float v2)
   return p;
 }
 
-// Function to generate triangles for a cube
-int GenerateTriangles(Vector3 *vertices, Vector3 *triangles, float *cornerValues, Vector3 *cornerPositions)
+// Voxel offset and axis (0 = x, 1 = y, 2 = z) of the base of each cube edge,
+// used to address edges shared between neighboring cells
+static const int8_t edgeBase[12][4] = {
+    {0, 0, 0, 0}, {1, 0, 0, 2}, {0, 0, 1, 0}, {0, 0, 0, 2}, {0, 1, 0, 0}, {1, 1, 0, 2}, {0, 1, 1, 0}, {0, 1, 0, 2}, {0, 0, 0, 1}, {1, 0, 0, 1}, {1, 0, 1, 1}, {0, 0, 1, 1}};
+
+// Cells along one axis of a chunk
+#define CELLS_PER_AXIS (CHUNK_SIZE - 1)
+
+// Voxels along one axis of a section, including the shared far boundary
+#define SECTION_VOXELS (SECTION_SIZE + 1)
+
+// Edge cache entries for one x-slice of section voxels (three edges per voxel)
+#define EDGE_CACHE_SLICE (SECTION_VOXELS * SECTION_VOXELS * 3)
+
+// Offset of each cube edge inside its x-slice of the edge cache, relative to the cell
+#define EDGE_CACHE_OFFSET(dy, dz, axis) ((((dy) * SECTION_VOXELS) + (dz)) * 3 + (axis))
+static const int16_t edgeCacheOffset[12] = {
+    EDGE_CACHE_OFFSET(0, 0, 0), EDGE_CACHE_OFFSET(0, 0, 2), EDGE_CACHE_OFFSET(0, 1, 0), EDGE_CACHE_OFFSET(0, 0, 2),
+    EDGE_CACHE_OFFSET(1, 0, 0), EDGE_CACHE_OFFSET(1, 0, 2), EDGE_CACHE_OFFSET(1, 1, 0), EDGE_CACHE_OFFSET(1, 0, 2),
+    EDGE_CACHE_OFFSET(0, 0, 1), EDGE_CACHE_OFFSET(0, 0, 1), EDGE_CACHE_OFFSET(0, 1, 1), EDGE_CACHE_OFFSET(0, 1, 1)};
+
+static inline int PopCount64(uint64_t value)
+{
+#if defined(_MSC_VER)
+  return (int)__popcnt64(value);
+#else
+  return __builtin_popcountll(value);
+#endif
+}
+
+static inline int CountTrailingZeros64(uint64_t value)
 {
-  int cubeIndex = 0;
-  Vector3 vertList[12];
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return (int)index;
+#else
+  return __builtin_ctzll(value);
+#endif
+}
 
-  // Initialize vertList to prevent any undefined behavior
-  for (int i = 0; i < 12; i++)
+// Surface threshold in stored voxel units
+#define SURFACE_THRESHOLD_STORED ((VoxelDensity)(SURFACE_THRESHOLD * VOXEL_DENSITY_SCALE))
+
+// Function to pack the inside/outside state of BRICK_SIZE consecutive voxels into the low bits of a mask
+static inline uint64_t PackBrickSigns(const Voxel *voxels)
+{
+#if VOXEL_DENSITY_BITS == 32 && defined(__AVX2__)
+  __m256 density = _mm256_loadu_ps(&voxels[0].density);
+  return (uint64_t)_mm256_movemask_ps(_mm256_cmp_ps(density, _mm256_set1_ps(SURFACE_THRESHOLD_STORED), _CMP_LT_OQ));
+#elif VOXEL_DENSITY_BITS == 32 && (defined(__SSE2__) || defined(_M_X64))
+  __m128 threshold = _mm_set1_ps(SURFACE_THRESHOLD_STORED);
+  return (uint64_t)(_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(&voxels[0].density), threshold)) |
+                    (_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(&voxels[4].density), threshold)) << 4));
+#elif VOXEL_DENSITY_BITS == 16 && (defined(__SSE2__) || defined(_M_X64))
+  __m128i inside = _mm_cmplt_epi16(_mm_loadu_si128((const __m128i *)voxels), _mm_set1_epi16(SURFACE_THRESHOLD_STORED));
+  return (uint64_t)(_mm_movemask_epi8(_mm_packs_epi16(inside, inside)) & 0xff);
+#elif VOXEL_DENSITY_BITS == 8 && (defined(__SSE2__) || defined(_M_X64))
+  __m128i inside = _mm_cmplt_epi8(_mm_loadl_epi64((const __m128i *)voxels), _mm_set1_epi8(SURFACE_THRESHOLD_STORED));
+  return (uint64_t)(_mm_movemask_epi8(inside) & 0xff);
+#else
+  uint64_t signs = 0;
+  for (int i = 0; i < BRICK_SIZE; i++)
   {
-    vertList[i] = (Vector3){0.0f, 0.0f, 0.0f};
+    if (voxels[i].density < SURFACE_THRESHOLD_STORED)
+      signs |= 1ULL << i;
   }
+  return signs;
+#endif
+}
 
-  // Determine cube index with explicit comparisons
-  for (int i = 0; i < 8; i++)
+// Function to pack the inside/outside state of the line (x, y) of a dense brick into the low bits of a mask
+static inline uint64_t PackBrickLineSigns(const BrickVoxels *brick, int x, int y)
+{
+#if VOXEL_LAYOUT == VOXEL_LAYOUT_LINEAR
+  // Lines along z are contiguous
+  return PackBrickSigns(&brick->voxels[GetBrickVoxelIndex(x, y, 0)]);
+#else
+  uint64_t signs = 0;
+  for (int z = 0; z < BRICK_SIZE; z++)
   {
-    if (cornerValues[i] < SURFACE_THRESHOLD)
-    {
-      cubeIndex |= (1 << i);
-    }
+    if (brick->voxels[GetBrickVoxelIndex(x, y, z)].density < SURFACE_THRESHOLD_STORED)
+      signs |= 1ULL << z;
   }
+  return signs;
+#endif
+}
 
-  // Cube is entirely inside/outside surface
-  if (edgeTable[cubeIndex] == 0)
-    return 0;
+// Function to pack the inside/outside state of one chunk line through bricks [bz0, bz1] into a bit mask (bit z = voxel z)
+// bricks is the row of bricks along z holding the line, (x, y) is the line inside those bricks
+// Uniform bricks and bricks entirely inside or outside are filled from their summary without reading voxels
+static uint64_t PackSignRow(const Brick *bricks, int x, int y, int bz0, int bz1)
+{
+  const uint64_t brickMask = (1ULL << BRICK_SIZE) - 1;
+  uint64_t signs = 0;
+
+  for (int bz = bz0; bz <= bz1; bz++)
+  {
+    int z = bz * BRICK_SIZE;
+    if (bricks[bz].maxDensity < SURFACE_THRESHOLD)
+      signs |= brickMask << z;
+    else if (bricks[bz].minDensity < SURFACE_THRESHOLD)
+      signs |= PackBrickLineSigns(bricks[bz].voxels, x, y) << z;
+  }
+  return signs;
+}
 
-  // Find vertices where surface intersects cube
-  // Use a lookup table to map edge index to vertex indices
-  static const int edgeToVerts[12][2] = {
-      {0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6}, {6, 7}, {7, 4}, {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+// Function to compute the cube indices of a row of cells from the sign rows of its four corner lines
+// a = (x, y), b = (x + 1, y), c = (x, y + 1), d = (x + 1, y + 1); only cells in mixedCells are required
+static void ComputeRowCubeIndices(uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t mixedCells,
+                                  unsigned char *cubeIndices)
+{
+  // Corner masks in marching cubes corner order, bit z belongs to cell z
+  const uint64_t corners[8] = {a, b, b >> 1, a >> 1, c, d, d >> 1, c >> 1};
 
-  for (int edge = 0; edge < 12; edge++)
+#if defined(__AVX2__)
+  // Transpose 8 corner masks into one byte per cell, 32 cells at a time
+  (void)mixedCells;
+  const __m256i spread = _mm256_setr_epi64x(0, 0x0101010101010101LL, 0x0202020202020202LL, 0x0303030303030303LL);
+  const __m256i bitSelect = _mm256_set1_epi64x((long long)0x8040201008040201ULL);
+  for (int z = 0; z < 64; z += 32)
   {
-    if (edgeTable[cubeIndex] & (1 << edge))
+    __m256i result = _mm256_setzero_si256();
+    for (int k = 0; k < 8; k++)
     {
-      int v1 = edgeToVerts[edge][0];
-      int v2 = edgeToVerts[edge][1];
-      vertList[edge] = VertexInterp(SURFACE_THRESHOLD,
-                                    cornerPositions[v1],
-                                    cornerPositions[v2],
-                                    cornerValues[v1],
-                                    cornerValues[v2]);
+      __m256i bits = _mm256_shuffle_epi8(_mm256_set1_epi32((int)(uint32_t)(corners[k] >> z)), spread);
+      bits = _mm256_cmpeq_epi8(_mm256_and_si256(bits, bitSelect), bitSelect);
+      result = _mm256_or_si256(result, _mm256_and_si256(bits, _mm256_set1_epi8((char)(1 << k))));
     }
+    _mm256_storeu_si256((__m256i *)&cubeIndices[z], result);
   }
-
-  // Create triangles
-  int numTriangles = 0;
-  for (int i = 0; triTable[cubeIndex][i] != -1; i += 3)
+#elif defined(__SSE2__) || defined(_M_X64)
+  // Transpose 8 corner masks into one byte per cell, 16 cells at a time
+  (void)mixedCells;
+  const __m128i bitSelect = _mm_set1_epi64x((long long)0x8040201008040201ULL);
+  for (int z = 0; z < 64; z += 16)
   {
-    // Validate indices before using them
-    int idx1 = triTable[cubeIndex][i];
-    int idx2 = triTable[cubeIndex][i + 1];
-    int idx3 = triTable[cubeIndex][i + 2];
+    __m128i result = _mm_setzero_si128();
+    for (int k = 0; k < 8; k++)
+    {
+      __m128i bits = _mm_cvtsi32_si128((int)((corners[k] >> z) & 0xffff));
+      bits = _mm_unpacklo_epi8(bits, bits);
+      bits = _mm_unpacklo_epi16(bits, bits);
+      bits = _mm_unpacklo_epi32(bits, bits);
+      bits = _mm_cmpeq_epi8(_mm_and_si128(bits, bitSelect), bitSelect);
+      result = _mm_or_si128(result, _mm_and_si128(bits, _mm_set1_epi8((char)(1 << k))));
+    }
+    _mm_storeu_si128((__m128i *)&cubeIndices[z], result);
+  }
+#else
+  // Scalar fallback only visits the cells the surface goes through
+  while (mixedCells)
+  {
+    int z = CountTrailingZeros64(mixedCells);
+    mixedCells &= mixedCells - 1;
 
-    if (idx1 >= 0 && idx1 < 12 && idx2 >= 0 && idx2 < 12 && idx3 >= 0 && idx3 < 12)
+    int cubeIndex = 0;
+    for (int k = 0; k < 8; k++)
     {
-      if (vertices != NULL)
-      {
-        vertices[numTriangles * 3] = vertList[idx1];
-        vertices[numTriangles * 3 + 1] = vertList[idx2];
-        vertices[numTriangles * 3 + 2] = vertList[idx3];
-      }
-      if (triangles != NULL)
-      {
-        triangles[numTriangles * 3] = vertList[idx1];
-        triangles[numTriangles * 3 + 1] = vertList[idx2];
-        triangles[numTriangles * 3 + 2] = vertList[idx3];
-      }
-      numTriangles++;
+      cubeIndex |= (int)((corners[k] >> z) & 1) << k;
     }
+    cubeIndices[z] = (unsigned char)cubeIndex;
+  }
+#endif
+}
+
+MeshingContext InitializeMeshingContext(void)
+{
+  MeshingContext context = {0};
+
+  // All buffers have a fixed size, so meshing never allocates scratch memory
+  context.signRows = (uint64_t *)RL_MALLOC(SECTION_VOXELS * SECTION_VOXELS * sizeof(uint64_t));
+  context.cellRows = (uint64_t *)RL_MALLOC(SECTION_SIZE * SECTION_SIZE * sizeof(uint64_t));
+  context.cubeIndices = (unsigned char *)RL_MALLOC(SECTION_SIZE * SECTION_SIZE * CHUNK_SIZE);
+  context.edgeCache = (int *)RL_MALLOC(2 * EDGE_CACHE_SLICE * sizeof(int));
+
+  return context;
+}
+
+void CleanupMeshingContext(MeshingContext *context)
+{
+  RL_FREE(context->signRows);
+  RL_FREE(context->cellRows);
+  RL_FREE(context->cubeIndices);
+  RL_FREE(context->edgeCache);
+  *context = (MeshingContext){0};
+}
+
+// Meshing context of every thread that meshes, freed by the key destructor when the thread exits
+static pthread_key_t threadContextKey;
+static pthread_once_t threadContextOnce = PTHREAD_ONCE_INIT;
+
+// Function to free the meshing context of an exiting thread
+static void DestroyThreadMeshingContext(void *data)
+{
+  CleanupMeshingContext((MeshingContext *)data);
+  RL_FREE(data);
+}
+
+static void CreateThreadMeshingContextKey(void)
+{
+  pthread_key_create(&threadContextKey, DestroyThreadMeshingContext);
+}
+
+MeshingContext *GetThreadMeshingContext(void)
+{
+  pthread_once(&threadContextOnce, CreateThreadMeshingContextKey);
+
+  MeshingContext *context = (MeshingContext *)pthread_getspecific(threadContextKey);
+  if (context)
+    return context;
+
+  context = (MeshingContext *)RL_MALLOC(sizeof(MeshingContext));
+  if (!context)
+    return NULL;
+
+  // Nothing is kept after a failure, so the next call tries again
+  *context = InitializeMeshingContext();
+  if (!context->signRows || !context->cellRows || !context->cubeIndices || !context->edgeCache ||
+      pthread_setspecific(threadContextKey, context) != 0)
+  {
+    DestroyThreadMeshingContext(context);
+    return NULL;
   }
+  return context;
+}
+
+void CleanupThreadMeshingContext(void)
+{
+  pthread_once(&threadContextOnce, CreateThreadMeshingContextKey);
+
+  MeshingContext *context = (MeshingContext *)pthread_getspecific(threadContextKey);
+  if (!context)
+    return;
 
-  return numTriangles;
+  pthread_setspecific(threadContextKey, NULL);
+  DestroyThreadMeshingContext(context);
 }
 
-// Function to generate mesh for a chunk
-Mesh GenerateChunkMesh(const Chunk *chunk)
+// Cell range [x0, x1) x [y0, y1) x [z0, z1) covered by one section
+typedef struct
 {
-  // Pre-allocate maximum possible vertices and triangles
-  const int maxTriangles = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE * 5;            // Approximate max triangles per cube
-  Vector3 *triangles = (Vector3 *)RL_CALLOC(maxTriangles * 3, sizeof(Vector3)); // Use CALLOC to ensure zero initialization
-  int totalTriangles = 0;
+  int x0, x1;
+  int y0, y1;
+  int z0, z1;
+} SectionBounds;
+
+static SectionBounds GetSectionBounds(int sx, int sy, int sz)
+{
+  SectionBounds bounds;
+  bounds.x0 = sx * SECTION_SIZE;
+  bounds.y0 = sy * SECTION_SIZE;
+  bounds.z0 = sz * SECTION_SIZE;
+  bounds.x1 = bounds.x0 + SECTION_SIZE < CELLS_PER_AXIS ? bounds.x0 + SECTION_SIZE : CELLS_PER_AXIS;
+  bounds.y1 = bounds.y0 + SECTION_SIZE < CELLS_PER_AXIS ? bounds.y0 + SECTION_SIZE : CELLS_PER_AXIS;
+  bounds.z1 = bounds.z0 + SECTION_SIZE < CELLS_PER_AXIS ? bounds.z0 + SECTION_SIZE : CELLS_PER_AXIS;
+  return bounds;
+}
+
+int ClassifySection(MeshingContext *context, const Chunk *chunk, int sx, int sy, int sz)
+{
+  SectionBounds b = GetSectionBounds(sx, sy, sz);
+  int cellsX = b.x1 - b.x0;
+  int cellsY = b.y1 - b.y0;
+  int triangleCount = 0;
+  int vertexCount = 0;
+  uint64_t *signRows = context->signRows;
+
+  // Row bits of the section cells, and of the section voxels including the far boundary
+  const uint64_t cellMask = ((1ULL << (b.z1 - b.z0)) - 1) << b.z0;
+  const uint64_t voxelMask = ((1ULL << (b.z1 - b.z0 + 1)) - 1) << b.z0;
+
+  // Pack the sign of every section voxel, one 64-bit row per chunk line along z
+  for (int x = 0; x <= cellsX; x++)
+  {
+    for (int y = 0; y <= cellsY; y++)
+    {
+      const Brick *bricks = chunk->bricks[(b.x0 + x) / BRICK_SIZE][(b.y0 + y) / BRICK_SIZE];
+      signRows[x * SECTION_VOXELS + y] = PackSignRow(bricks, (b.x0 + x) % BRICK_SIZE, (b.y0 + y) % BRICK_SIZE,
+                                                     b.z0 / BRICK_SIZE, b.z1 / BRICK_SIZE);
+    }
+  }
 
-  // Process each cube in the chunk
-  for (int x = 0; x < CHUNK_SIZE - 1; x++)
+  for (int x = 0; x <= cellsX; x++)
   {
-    for (int y = 0; y < CHUNK_SIZE - 1; y++)
+    const uint64_t *plane = &signRows[x * SECTION_VOXELS];
+    const uint64_t *nextPlane = plane + SECTION_VOXELS;
+
+    // Count the y and z edges of this voxel plane, and the x edges leaving it
+    for (int y = 0; y <= cellsY; y++)
+    {
+      vertexCount += PopCount64((plane[y] ^ (plane[y] >> 1)) & cellMask);
+      if (y < cellsY)
+        vertexCount += PopCount64((plane[y] ^ plane[y + 1]) & voxelMask);
+      if (x < cellsX)
+        vertexCount += PopCount64((plane[y] ^ nextPlane[y]) & voxelMask);
+    }
+
+    if (x == cellsX)
+      break;
+
+    // Classify the cells between this plane and the next one
+    for (int y = 0; y < cellsY; y++)
     {
-      for (int z = 0; z < CHUNK_SIZE - 1; z++)
+      uint64_t a = plane[y];
+      uint64_t b = nextPlane[y];
+      uint64_t c = plane[y + 1];
+      uint64_t d = nextPlane[y + 1];
+
+      // A cell is mixed when its 8 corners disagree, most rows have none
+      uint64_t any = a | b | c | d;
+      uint64_t all = a & b & c & d;
+      uint64_t mixedCells = ((any | (any >> 1)) & ~(all & (all >> 1))) & cellMask;
+      context->cellRows[x * SECTION_SIZE + y] = mixedCells;
+
+      if (mixedCells == 0)
+        continue;
+
+      unsigned char *cubeIndices = &context->cubeIndices[(x * SECTION_SIZE + y) * CHUNK_SIZE];
+      ComputeRowCubeIndices(a, b, c, d, mixedCells, cubeIndices);
+
+      while (mixedCells)
       {
-        float cornerValues[8];
-        Vector3 cornerPositions[8];
-
-        // Get corner values and positions with bounds checking
-        if (x < 0 || x >= CHUNK_SIZE - 1 || y < 0 || y >= CHUNK_SIZE - 1 ||
-            z < 0 || z >= CHUNK_SIZE - 1)
-          continue;
-
-        // Get corner values and positions
-        cornerValues[0] = chunk->voxels[x][y][z].density;
-        cornerValues[1] = chunk->voxels[x + 1][y][z].density;
-        cornerValues[2] = chunk->voxels[x + 1][y][z + 1].density;
-        cornerValues[3] = chunk->voxels[x][y][z + 1].density;
-        cornerValues[4] = chunk->voxels[x][y + 1][z].density;
-        cornerValues[5] = chunk->voxels[x + 1][y + 1][z].density;
-        cornerValues[6] = chunk->voxels[x + 1][y + 1][z + 1].density;
-        cornerValues[7] = chunk->voxels[x][y + 1][z + 1].density;
-
-        // Set corner positions in local chunk space
-        const float vsize = VOXEL_SIZE;
-        cornerPositions[0] = (Vector3){x * vsize, y * vsize, z * vsize};
-        cornerPositions[1] = (Vector3){(x + 1) * vsize, y * vsize, z * vsize};
-        cornerPositions[2] = (Vector3){(x + 1) * vsize, y * vsize, (z + 1) * vsize};
-        cornerPositions[3] = (Vector3){x * vsize, y * vsize, (z + 1) * vsize};
-        cornerPositions[4] = (Vector3){x * vsize, (y + 1) * vsize, z * vsize};
-        cornerPositions[5] = (Vector3){(x + 1) * vsize, (y + 1) * vsize, z * vsize};
-        cornerPositions[6] = (Vector3){(x + 1) * vsize, (y + 1) * vsize, (z + 1) * vsize};
-        cornerPositions[7] = (Vector3){x * vsize, (y + 1) * vsize, (z + 1) * vsize};
-
-        // Generate triangles for this cube
-        if (totalTriangles < maxTriangles - 5)
-        { // Ensure we don't overflow
-          int numTriangles = GenerateTriangles(NULL, &triangles[totalTriangles * 3],
-                                               cornerValues, cornerPositions);
-          totalTriangles += numTriangles;
-        }
+        int z = CountTrailingZeros64(mixedCells);
+        mixedCells &= mixedCells - 1;
+        triangleCount += triangleCountTable[cubeIndices[z]];
       }
     }
   }
 
-  // Create mesh
-  Mesh mesh = {0};
-  mesh.triangleCount = totalTriangles;
-  mesh.vertexCount = totalTriangles * 3;
+  context->triangleCount = triangleCount;
+  context->vertexCount = vertexCount;
+  return triangleCount;
+}
+
+// Function to get the density gradient at a voxel, one-sided at the chunk border
+static Vector3 GetDensityGradient(const Chunk *chunk, int x, int y, int z)
+{
+  int x0 = x > 0 ? x - 1 : x, x1 = x < CHUNK_SIZE - 1 ? x + 1 : x;
+  int y0 = y > 0 ? y - 1 : y, y1 = y < CHUNK_SIZE - 1 ? y + 1 : y;
+  int z0 = z > 0 ? z - 1 : z, z1 = z < CHUNK_SIZE - 1 ? z + 1 : z;
+
+  return (Vector3){
+      (GetChunkDensity(chunk, x1, y, z) - GetChunkDensity(chunk, x0, y, z)) / (x1 - x0),
+      (GetChunkDensity(chunk, x, y1, z) - GetChunkDensity(chunk, x, y0, z)) / (y1 - y0),
+      (GetChunkDensity(chunk, x, y, z1) - GetChunkDensity(chunk, x, y, z0)) / (z1 - z0)};
+}
 
-  // Allocate and initialize mesh data
-  mesh.vertices = (float *)RL_CALLOC(mesh.vertexCount * 3, sizeof(float));
-  mesh.indices = (unsigned short *)RL_CALLOC(mesh.vertexCount, sizeof(unsigned short));
-  mesh.texcoords = (float *)RL_CALLOC(mesh.vertexCount * 2, sizeof(float));
-  mesh.normals = (float *)RL_CALLOC(mesh.vertexCount * 3, sizeof(float));
+// Function to encode a unit normal into two snorm8 octahedral coordinates, y is the folded axis
+static void EncodeOctahedralNormal(Vector3 normal, int8_t encoded[2])
+{
+  float length = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
 
-  if (!mesh.vertices || !mesh.indices || !mesh.texcoords || !mesh.normals)
+  // Gradients that cancel out, e.g. across one-voxel-thin features, leave no direction, point them up
+  if (length == 0.0f)
   {
-    // Handle allocation failure
-    if (mesh.vertices)
-      RL_FREE(mesh.vertices);
-    if (mesh.indices)
-      RL_FREE(mesh.indices);
-    if (mesh.texcoords)
-      RL_FREE(mesh.texcoords);
-    if (mesh.normals)
-      RL_FREE(mesh.normals);
-    RL_FREE(triangles);
-    return (Mesh){0};
+    encoded[0] = 0;
+    encoded[1] = 0;
+    return;
   }
 
-  // Copy vertex data
-  for (int i = 0; i < mesh.vertexCount; i++)
+  float u = normal.x / length;
+  float v = normal.z / length;
+
+  // Fold the lower hemisphere over the diagonals
+  if (normal.y < 0.0f)
+  {
+    float foldedU = (1.0f - fabsf(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+    float foldedV = (1.0f - fabsf(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+    u = foldedU;
+    v = foldedV;
+  }
+
+  encoded[0] = (int8_t)roundf(Clamp(u, -1.0f, 1.0f) * 127.0f);
+  encoded[1] = (int8_t)roundf(Clamp(v, -1.0f, 1.0f) * 127.0f);
+}
+
+void SetChunkVertexAttributes(void)
+{
+  rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 3, RL_UNSIGNED_SHORT, false,
+                       sizeof(ChunkVertex), offsetof(ChunkVertex, position));
+  rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+  rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, 2, RL_BYTE, true,
+                       sizeof(ChunkVertex), offsetof(ChunkVertex, normal));
+  rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL);
+}
+
+SectionMeshData BuildSectionMesh(MeshingContext *context, const Chunk *chunk, int sx, int sy, int sz)
+{
+  SectionMeshData data = {0};
+  if (!context->signRows || !context->cellRows || !context->cubeIndices || !context->edgeCache)
+    return data;
+
+  // First pass: classify cells and count vertices and triangles
+  if (ClassifySection(context, chunk, sx, sy, sz) == 0)
+    return data;
+
+  SectionBounds b = GetSectionBounds(sx, sy, sz);
+  int cellsX = b.x1 - b.x0;
+  int cellsY = b.y1 - b.y0;
+
+  data.vertexCount = context->vertexCount;
+  data.triangleCount = context->triangleCount;
+
+  ChunkVertex *vertices = (ChunkVertex *)AllocateMeshArray(data.vertexCount * sizeof(ChunkVertex));
+  data.indices = (unsigned short *)AllocateMeshArray(data.triangleCount * 3 * sizeof(unsigned short));
+  data.vertices = vertices;
+
+  if (!vertices || !data.indices)
   {
-    mesh.vertices[i * 3] = triangles[i].x;
-    mesh.vertices[i * 3 + 1] = triangles[i].y;
-    mesh.vertices[i * 3 + 2] = triangles[i].z;
-    mesh.indices[i] = i;
-    mesh.texcoords[i * 2] = triangles[i].x * 0.1f;
-    mesh.texcoords[i * 2 + 1] = triangles[i].z * 0.1f;
+    UnloadSectionMeshData(&data);
+    return data;
   }
 
-  // Calculate normals for each triangle
-  for (int i = 0; i < mesh.triangleCount; i++)
+  // Second pass: emit straight into the exactly sized arrays
+  // Vertex index of each edge crossing in the current and next x-slice
+  int *edgeCache = context->edgeCache;
+  memset(edgeCache, 0xff, 2 * EDGE_CACHE_SLICE * sizeof(int));
+
+  unsigned short *indices = data.indices;
+  int emittedVertices = 0;
+  int emittedIndices = 0;
+
+  for (int lx = 0; lx < cellsX; lx++)
   {
-    Vector3 v1 = (Vector3){
-        mesh.vertices[i * 9],
-        mesh.vertices[i * 9 + 1],
-        mesh.vertices[i * 9 + 2]};
-    Vector3 v2 = (Vector3){
-        mesh.vertices[i * 9 + 3],
-        mesh.vertices[i * 9 + 4],
-        mesh.vertices[i * 9 + 5]};
-    Vector3 v3 = (Vector3){
-        mesh.vertices[i * 9 + 6],
-        mesh.vertices[i * 9 + 7],
-        mesh.vertices[i * 9 + 8]};
-
-    // Calculate triangle normal
-    Vector3 edge1 = Vector3Subtract(v2, v1);
-    Vector3 edge2 = Vector3Subtract(v3, v1);
-    Vector3 normal = Vector3Normalize(Vector3CrossProduct(edge1, edge2));
-
-    // Assign normal to all three vertices of the triangle
-    for (int j = 0; j < 3; j++)
+    int x = b.x0 + lx;
+    int *slices[2] = {
+        edgeCache + (lx & 1) * EDGE_CACHE_SLICE,
+        edgeCache + ((lx + 1) & 1) * EDGE_CACHE_SLICE};
+
+    // The next slice still holds the edges of slice x - 1
+    if (lx > 0)
+      memset(slices[1], 0xff, EDGE_CACHE_SLICE * sizeof(int));
+
+    for (int ly = 0; ly < cellsY; ly++)
     {
-      mesh.normals[(i * 3 + j) * 3] = normal.x;
-      mesh.normals[(i * 3 + j) * 3 + 1] = normal.y;
-      mesh.normals[(i * 3 + j) * 3 + 2] = normal.z;
+      int y = b.y0 + ly;
+
+      // Only visit the cells the surface goes through
+      uint64_t mixedCells = context->cellRows[lx * SECTION_SIZE + ly];
+      const unsigned char *cubeIndices = &context->cubeIndices[(lx * SECTION_SIZE + ly) * CHUNK_SIZE];
+
+      while (mixedCells)
+      {
+        int z = CountTrailingZeros64(mixedCells);
+        mixedCells &= mixedCells - 1;
+
+        int cubeIndex = cubeIndices[z];
+        int *cellCache = &slices[0][(ly * SECTION_VOXELS + z - b.z0) * 3];
+        int *nextCellCache = &slices[1][(ly * SECTION_VOXELS + z - b.z0) * 3];
+
+        // Find or create the vertex on each edge the surface crosses
+        int cellVertices[12];
+        uint64_t crossedEdges = edgeTable[cubeIndex];
+        while (crossedEdges)
+        {
+          int edge = CountTrailingZeros64(crossedEdges);
+          crossedEdges &= crossedEdges - 1;
+
+          int *cached = (edgeBase[edge][0] ? nextCellCache : cellCache) + edgeCacheOffset[edge];
+
+          if (*cached < 0)
+          {
+            int axis = edgeBase[edge][3];
+            int x1 = x + edgeBase[edge][0], x2 = x1 + (axis == 0);
+            int y1 = y + edgeBase[edge][1], y2 = y1 + (axis == 1);
+            int z1 = z + edgeBase[edge][2], z2 = z1 + (axis == 2);
+
+            float mu = GetInterpFactor(SURFACE_THRESHOLD, GetChunkDensity(chunk, x1, y1, z1),
+                                       GetChunkDensity(chunk, x2, y2, z2));
+
+            // Positions are chunk-local, in 1/CHUNK_POSITION_STEPS voxel units
+            ChunkVertex *vertex = &vertices[emittedVertices];
+            vertex->position[0] = (uint16_t)((x1 + mu * (x2 - x1)) * CHUNK_POSITION_STEPS + 0.5f);
+            vertex->position[1] = (uint16_t)((y1 + mu * (y2 - y1)) * CHUNK_POSITION_STEPS + 0.5f);
+            vertex->position[2] = (uint16_t)((z1 + mu * (z2 - z1)) * CHUNK_POSITION_STEPS + 0.5f);
+
+            // Normals follow the density gradient, so vertices duplicated on section borders match
+            Vector3 normal = Vector3Normalize(Vector3Lerp(GetDensityGradient(chunk, x1, y1, z1),
+                                                          GetDensityGradient(chunk, x2, y2, z2), mu));
+            EncodeOctahedralNormal(normal, vertex->normal);
+
+            *cached = emittedVertices++;
+          }
+          cellVertices[edge] = *cached;
+        }
+
+        // Create triangles
+        for (int i = 0; triTable[cubeIndex][i] != -1; i += 3)
+        {
+          indices[emittedIndices++] = (unsigned short)cellVertices[triTable[cubeIndex][i]];
+          indices[emittedIndices++] = (unsigned short)cellVertices[triTable[cubeIndex][i + 1]];
+          indices[emittedIndices++] = (unsigned short)cellVertices[triTable[cubeIndex][i + 2]];
+        }
+      }
     }
   }
 
-  // Free temporary triangle data
-  RL_FREE(triangles);
+  return data;
+}
 
-  // Upload mesh to GPU
-  UploadMesh(&mesh, false);
+void UnloadSectionMeshData(SectionMeshData *data)
+{
+  FreeMeshArray(data->vertices);
+  FreeMeshArray(data->indices);
+  *data = (SectionMeshData){0};
+}
 
-  return mesh;
+int GetSectionMeshDataSize(const SectionMeshData *data)
+{
+  return data->vertexCount * (int)sizeof(ChunkVertex) + data->triangleCount * 3 * (int)sizeof(unsigned short);
+}
+
+int GetSectionMeshDataArraySize(const SectionMeshData *data, int count)
+{
+  int size = 0;
+  for (int i = 0; i < count; i++)
+  {
+    size += GetSectionMeshDataSize(&data[i]);
+  }
+  return size;
 }
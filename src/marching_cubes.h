@@ -4,17 +4,76 @@
 #include "raylib.h"
 #include "raymath.h"
 #include "chunk.h"
+#include <stdint.h>
 
 // Vertex interpolation threshold
 #define SURFACE_THRESHOLD 0.0f
 
+// Maximum vertices in one mesh, bounded by raylib's 16-bit mesh indices
+#define MESH_MAX_VERTICES 65535
+
+// Subdivisions of a voxel in chunk mesh vertex positions
+#define CHUNK_POSITION_STEPS 1024
+
+// Compact chunk mesh vertex (8 bytes), decoded in lighting_shader.vs
+typedef struct
+{
+  uint16_t position[3]; // Chunk-local position in 1/CHUNK_POSITION_STEPS voxel units
+  int8_t normal[2];     // Octahedral-encoded normal, snorm8
+} ChunkVertex;
+
+// Vertices and indices of a section mesh built away from the render thread, both NULL when the section is empty
+// The arrays come from the mesh pool, release them with UnloadSectionMeshData
+typedef struct
+{
+  ChunkVertex *vertices;
+  unsigned short *indices;
+  int vertexCount;
+  int triangleCount;
+} SectionMeshData;
+
+// Reusable scratch buffers for meshing one section at a time, one per meshing thread
+typedef struct
+{
+  uint64_t *signRows;         // Inside bit of every section voxel, one 64-bit row per chunk line along z
+  uint64_t *cellRows;         // Cells the surface goes through, one 64-bit row per line of section cells
+  unsigned char *cubeIndices; // Marching cubes case of every cell, rows padded to CHUNK_SIZE
+  int *edgeCache;             // Vertex index per edge crossing, two x-slices
+  int triangleCount;          // Triangles in the last classified section
+  int vertexCount;            // Shared vertices in the last classified section
+} MeshingContext;
+
 // Function to get interpolated position between two vertices
 Vector3 VertexInterp(float isolevel, Vector3 p1, Vector3 p2, float v1, float v2);
 
-// Function to generate triangles for a cube
-int GenerateTriangles(Vector3 *vertices, Vector3 *triangles, float *cornerValues, Vector3 *cornerPositions);
+// Meshing context management, scratch buffers are kept between calls
+MeshingContext InitializeMeshingContext(void);
+void CleanupMeshingContext(MeshingContext *context);
+
+// Function to get the meshing context of the calling thread, created on first use, returns NULL when memory runs out
+// Job system workers free theirs when CleanupJobSystem stops them
+MeshingContext *GetThreadMeshingContext(void);
+
+// Function to free the meshing context of the calling thread, for threads outside the job system
+void CleanupThreadMeshingContext(void);
+
+// Function to classify every cell of a section, returns the number of triangles it will produce
+int ClassifySection(MeshingContext *context, const Chunk *chunk, int sx, int sy, int sz);
+
+// Function to build the vertices and indices of a section without touching the GPU, safe on any thread
+SectionMeshData BuildSectionMesh(MeshingContext *context, const Chunk *chunk, int sx, int sy, int sz);
+
+// Function to point the position and normal attributes of the bound vertex array at ChunkVertex data in the bound
+// vertex buffer
+void SetChunkVertexAttributes(void);
+
+// Function to free section mesh data that will not be uploaded
+void UnloadSectionMeshData(SectionMeshData *data);
+
+// Function to get the number of bytes uploading section mesh data sends to the GPU
+int GetSectionMeshDataSize(const SectionMeshData *data);
 
-// Function to generate mesh for a chunk
-Mesh GenerateChunkMesh(const Chunk *chunk);
+// Function to get the number of bytes uploading count section meshes sends to the GPU
+int GetSectionMeshDataArraySize(const SectionMeshData *data, int count);
 
 #endif // MARCHING_CUBES_H
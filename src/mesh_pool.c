@@ -0,0 +1,193 @@
+#include "mesh_pool.h"
+#include "raylib.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Header in front of every array, 16 bytes so the array keeps the system allocator's alignment
+typedef struct
+{
+  int sizeClass; // MESH_POOL_CLASSES for arrays allocated directly
+  int size;      // Bytes requested
+  int padding[2];
+} MeshArrayHeader;
+
+// Idle block, linked through the bytes after its header
+typedef struct MeshPoolBlock
+{
+  struct MeshPoolBlock *next;
+} MeshPoolBlock;
+
+typedef struct
+{
+  pthread_mutex_t mutex;
+  MeshPoolBlock *freeBlocks;
+  int freeCount;
+  int usedCount;
+  size_t requestedBytes; // Asked for by the live arrays of the class
+  size_t directBytes;    // Held by live arrays allocated directly, only used by the last class
+  long long allocations;
+  long long reuses;
+} MeshPoolClass;
+
+// One lock per class keeps workers meshing different section sizes out of each other's way
+static MeshPoolClass pool[MESH_POOL_CLASSES + 1];
+static pthread_once_t poolOnce = PTHREAD_ONCE_INIT;
+
+// Function to create the class locks, once before the pool is first used
+static void InitializeMeshPool(void)
+{
+  for (int i = 0; i <= MESH_POOL_CLASSES; i++)
+  {
+    pthread_mutex_init(&pool[i].mutex, NULL);
+  }
+}
+
+// Function to get the block size of a class, header included
+static int GetClassBlockSize(int sizeClass)
+{
+  return MESH_POOL_MIN_BLOCK << sizeClass;
+}
+
+// Function to get the smallest class whose blocks hold size bytes and the header, MESH_POOL_CLASSES when none does
+static int GetSizeClass(int size)
+{
+  int sizeClass = 0;
+  while (sizeClass < MESH_POOL_CLASSES && GetClassBlockSize(sizeClass) < size + (int)sizeof(MeshArrayHeader))
+    sizeClass++;
+  return sizeClass;
+}
+
+void *AllocateMeshArray(int size)
+{
+  if (size <= 0)
+    return NULL;
+
+  pthread_once(&poolOnce, InitializeMeshPool);
+
+  int sizeClass = GetSizeClass(size);
+  MeshPoolClass *class = &pool[sizeClass];
+  MeshArrayHeader *header = NULL;
+
+  pthread_mutex_lock(&class->mutex);
+  if (class->freeBlocks)
+  {
+    MeshPoolBlock *block = class->freeBlocks;
+    class->freeBlocks = block->next;
+    class->freeCount--;
+    class->reuses++;
+    header = (MeshArrayHeader *)block - 1;
+  }
+  pthread_mutex_unlock(&class->mutex);
+
+  if (!header)
+  {
+    size_t blockSize = sizeClass < MESH_POOL_CLASSES ? (size_t)GetClassBlockSize(sizeClass) : sizeof(MeshArrayHeader) + size;
+    header = (MeshArrayHeader *)RL_MALLOC(blockSize);
+    if (!header)
+      return NULL;
+  }
+
+  header->sizeClass = sizeClass;
+  header->size = size;
+
+  pthread_mutex_lock(&class->mutex);
+  class->usedCount++;
+  class->requestedBytes += size;
+  class->allocations++;
+  if (sizeClass == MESH_POOL_CLASSES)
+    class->directBytes += sizeof(MeshArrayHeader) + size;
+  pthread_mutex_unlock(&class->mutex);
+
+  return header + 1;
+}
+
+void FreeMeshArray(void *array)
+{
+  if (!array)
+    return;
+
+  MeshArrayHeader *header = (MeshArrayHeader *)array - 1;
+  int sizeClass = header->sizeClass;
+  MeshPoolClass *class = &pool[sizeClass];
+
+  pthread_mutex_lock(&class->mutex);
+  class->usedCount--;
+  class->requestedBytes -= header->size;
+  if (sizeClass == MESH_POOL_CLASSES)
+    class->directBytes -= sizeof(MeshArrayHeader) + header->size;
+
+  // Keep the block for the next array of this class unless the class already holds enough idle memory
+  bool keep = sizeClass < MESH_POOL_CLASSES &&
+              (size_t)(class->freeCount + 1) * GetClassBlockSize(sizeClass) <= MESH_POOL_CLASS_CACHE_BYTES;
+  if (keep)
+  {
+    MeshPoolBlock *block = array;
+    block->next = class->freeBlocks;
+    class->freeBlocks = block;
+    class->freeCount++;
+  }
+  pthread_mutex_unlock(&class->mutex);
+
+  if (!keep)
+    RL_FREE(header);
+}
+
+void TrimMeshPool(void)
+{
+  pthread_once(&poolOnce, InitializeMeshPool);
+
+  for (int i = 0; i < MESH_POOL_CLASSES; i++)
+  {
+    MeshPoolClass *class = &pool[i];
+    pthread_mutex_lock(&class->mutex);
+    MeshPoolBlock *block = class->freeBlocks;
+    class->freeBlocks = NULL;
+    class->freeCount = 0;
+    pthread_mutex_unlock(&class->mutex);
+
+    while (block)
+    {
+      MeshPoolBlock *next = block->next;
+      RL_FREE((MeshArrayHeader *)block - 1);
+      block = next;
+    }
+  }
+}
+
+MeshPoolStats GetMeshPoolStats(void)
+{
+  pthread_once(&poolOnce, InitializeMeshPool);
+
+  MeshPoolStats stats = {0};
+  long long allocations = 0;
+  long long reuses = 0;
+
+  for (int i = 0; i <= MESH_POOL_CLASSES; i++)
+  {
+    MeshPoolClass *class = &pool[i];
+    MeshPoolClassStats *classStats = &stats.classes[i];
+
+    pthread_mutex_lock(&class->mutex);
+    classStats->blockSize = i < MESH_POOL_CLASSES ? GetClassBlockSize(i) : 0;
+    classStats->usedBlocks = class->usedCount;
+    classStats->freeBlocks = class->freeCount;
+    classStats->allocations = class->allocations;
+    classStats->reuses = class->reuses;
+    stats.requestedBytes += class->requestedBytes;
+    stats.usedBytes += i < MESH_POOL_CLASSES ? (size_t)class->usedCount * classStats->blockSize : class->directBytes;
+    stats.freeBytes += (size_t)class->freeCount * classStats->blockSize;
+    pthread_mutex_unlock(&class->mutex);
+
+    allocations += classStats->allocations;
+    reuses += classStats->reuses;
+  }
+
+  size_t heldBytes = stats.usedBytes + stats.freeBytes;
+  if (heldBytes > 0)
+    stats.fragmentation = (float)(heldBytes - stats.requestedBytes) / (float)heldBytes;
+  if (allocations > 0)
+    stats.reuseRate = (float)reuses / (float)allocations;
+
+  return stats;
+}
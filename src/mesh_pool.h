@@ -0,0 +1,47 @@
+#ifndef MESH_POOL_H
+#define MESH_POOL_H
+
+#include <stddef.h>
+
+// Size classes double from MESH_POOL_MIN_BLOCK, the largest holds the biggest section mesh array
+#define MESH_POOL_MIN_BLOCK 256
+#define MESH_POOL_CLASSES 10 // 256 B to 128 KB
+
+// Idle bytes kept per size class, blocks freed beyond this go back to the system
+#define MESH_POOL_CLASS_CACHE_BYTES (4 * 1024 * 1024)
+
+// Blocks of one size class
+typedef struct
+{
+  int blockSize; // Bytes per block, 0 for arrays too large for every class
+  int usedBlocks;
+  int freeBlocks;
+  long long allocations;
+  long long reuses; // Allocations served by a recycled block
+} MeshPoolClassStats;
+
+// Usage of the mesh array pool, for tuning the size classes and cache limit
+typedef struct
+{
+  MeshPoolClassStats classes[MESH_POOL_CLASSES + 1]; // The last entry counts arrays too large for the pool
+  size_t requestedBytes; // Asked for by the live arrays
+  size_t usedBytes;      // Held by the live arrays, the rest of each block is lost to rounding up
+  size_t freeBytes;      // Idle blocks waiting for reuse
+  float fragmentation;   // Share of the held memory not holding array data
+  float reuseRate;       // Share of allocations served by a recycled block
+} MeshPoolStats;
+
+// Function to allocate a mesh array from the pool, safe on any thread, returns NULL when size is 0 or memory runs out
+// Arrays are recycled between remeshes and across chunks, so continuous edits do not reach the system allocator
+void *AllocateMeshArray(int size);
+
+// Function to give an array from AllocateMeshArray back to the pool, safe on any thread
+void FreeMeshArray(void *array);
+
+// Function to release every idle block to the system
+void TrimMeshPool(void);
+
+// Function to get the usage of the pool
+MeshPoolStats GetMeshPoolStats(void);
+
+#endif // MESH_POOL_H
@@ -0,0 +1,313 @@
+#include "noise.h"
+#include <math.h>
+#include <stdbool.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+// Hash constants, the SIMD paths below must use the same ones
+#define NOISE_HASH_X 0x27D4EB2Du
+#define NOISE_HASH_Y 0x165667B1u
+#define NOISE_HASH_MIX 0x2C1B3C6Du
+
+// Every path evaluates the same float operations in the same order, so batches match
+// GradientNoise2D bit for bit as long as the compiler does not contract them into FMAs,
+// CMakeLists.txt turns contraction off for this reason
+
+// Function to hash a lattice cell, the low three bits pick the gradient
+static inline uint32_t HashNoiseCell(uint32_t hashX, uint32_t hashY, uint32_t seed)
+{
+  uint32_t hash = seed ^ hashX ^ hashY;
+  hash ^= hash >> 15;
+  hash *= NOISE_HASH_MIX;
+  hash ^= hash >> 13;
+  return hash;
+}
+
+// Function to get the dot product of a lattice gradient and an offset
+// Gradients are the four diagonals (h & 4 == 0) and the four axes
+static inline float GradientDot(uint32_t hash, float x, float y)
+{
+  float signX = (hash & 1) ? -1.0f : 1.0f;
+  float signY = (hash & 2) ? -1.0f : 1.0f;
+  if (hash & 4)
+    return ((hash & 1) ? y : x) * signY + 0.0f;
+  return x * signX + y * signY;
+}
+
+// Quintic fade curve, zero first and second derivatives at lattice points
+static inline float NoiseFade(float t)
+{
+  return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+float GradientNoise2D(float x, float y, uint32_t seed)
+{
+  float floorX = floorf(x);
+  float floorY = floorf(y);
+  float fx = x - floorX;
+  float fy = y - floorY;
+
+  uint32_t hashX0 = (uint32_t)(int32_t)floorX * NOISE_HASH_X;
+  uint32_t hashY0 = (uint32_t)(int32_t)floorY * NOISE_HASH_Y;
+  uint32_t hashX1 = hashX0 + NOISE_HASH_X;
+  uint32_t hashY1 = hashY0 + NOISE_HASH_Y;
+
+  float g00 = GradientDot(HashNoiseCell(hashX0, hashY0, seed), fx, fy);
+  float g10 = GradientDot(HashNoiseCell(hashX1, hashY0, seed), fx - 1.0f, fy);
+  float g01 = GradientDot(HashNoiseCell(hashX0, hashY1, seed), fx, fy - 1.0f);
+  float g11 = GradientDot(HashNoiseCell(hashX1, hashY1, seed), fx - 1.0f, fy - 1.0f);
+
+  float u = NoiseFade(fx);
+  float v = NoiseFade(fy);
+  float a = g00 + u * (g10 - g00);
+  float b = g01 + u * (g11 - g01);
+  return a + v * (b - a);
+}
+
+#if defined(__AVX2__)
+
+static inline __m256i HashNoiseCellLanes(__m256i hashX, __m256i hashY, __m256i seed)
+{
+  __m256i hash = _mm256_xor_si256(seed, _mm256_xor_si256(hashX, hashY));
+  hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 15));
+  hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32((int)NOISE_HASH_MIX));
+  return _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 13));
+}
+
+static inline __m256 GradientDotLanes(__m256i hash, __m256 x, __m256 y)
+{
+  __m256i one = _mm256_set1_epi32(1);
+  __m256i two = _mm256_set1_epi32(2);
+  __m256i four = _mm256_set1_epi32(4);
+  __m256 signX = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(hash, one), 31));
+  __m256 signY = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(hash, two), 30));
+  __m256 axis = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(hash, four), four));
+  __m256 pickY = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(hash, one), one));
+
+  // Sign flips are exact, so xor with the sign bit matches the scalar multiply by -1
+  __m256 axisDot = _mm256_add_ps(_mm256_xor_ps(_mm256_blendv_ps(x, y, pickY), signY), _mm256_setzero_ps());
+  __m256 diagonalDot = _mm256_add_ps(_mm256_xor_ps(x, signX), _mm256_xor_ps(y, signY));
+  return _mm256_blendv_ps(diagonalDot, axisDot, axis);
+}
+
+static inline __m256 NoiseFadeLanes(__m256 t)
+{
+  __m256 inner = _mm256_add_ps(_mm256_mul_ps(t, _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f))), _mm256_set1_ps(10.0f));
+  return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), inner);
+}
+
+// Function to evaluate 8 points, returns the number of points handled
+static int GradientNoise2DLanes(const float *x, const float *y, float *out, int count, uint32_t seed)
+{
+  int i = 0;
+  __m256i seedLanes = _mm256_set1_epi32((int)seed);
+  __m256 one = _mm256_set1_ps(1.0f);
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 px = _mm256_loadu_ps(x + i);
+    __m256 py = _mm256_loadu_ps(y + i);
+    __m256 floorX = _mm256_floor_ps(px);
+    __m256 floorY = _mm256_floor_ps(py);
+    __m256 fx = _mm256_sub_ps(px, floorX);
+    __m256 fy = _mm256_sub_ps(py, floorY);
+
+    __m256i hashX0 = _mm256_mullo_epi32(_mm256_cvttps_epi32(floorX), _mm256_set1_epi32((int)NOISE_HASH_X));
+    __m256i hashY0 = _mm256_mullo_epi32(_mm256_cvttps_epi32(floorY), _mm256_set1_epi32((int)NOISE_HASH_Y));
+    __m256i hashX1 = _mm256_add_epi32(hashX0, _mm256_set1_epi32((int)NOISE_HASH_X));
+    __m256i hashY1 = _mm256_add_epi32(hashY0, _mm256_set1_epi32((int)NOISE_HASH_Y));
+
+    __m256 fx1 = _mm256_sub_ps(fx, one);
+    __m256 fy1 = _mm256_sub_ps(fy, one);
+    __m256 g00 = GradientDotLanes(HashNoiseCellLanes(hashX0, hashY0, seedLanes), fx, fy);
+    __m256 g10 = GradientDotLanes(HashNoiseCellLanes(hashX1, hashY0, seedLanes), fx1, fy);
+    __m256 g01 = GradientDotLanes(HashNoiseCellLanes(hashX0, hashY1, seedLanes), fx, fy1);
+    __m256 g11 = GradientDotLanes(HashNoiseCellLanes(hashX1, hashY1, seedLanes), fx1, fy1);
+
+    __m256 u = NoiseFadeLanes(fx);
+    __m256 v = NoiseFadeLanes(fy);
+    __m256 a = _mm256_add_ps(g00, _mm256_mul_ps(u, _mm256_sub_ps(g10, g00)));
+    __m256 b = _mm256_add_ps(g01, _mm256_mul_ps(u, _mm256_sub_ps(g11, g01)));
+    _mm256_storeu_ps(out + i, _mm256_add_ps(a, _mm256_mul_ps(v, _mm256_sub_ps(b, a))));
+  }
+  return i;
+}
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+// SSE2 has no 32-bit low multiply, combine the even and odd lane products
+static inline __m128i MultiplyLow32(__m128i a, __m128i b)
+{
+  __m128i even = _mm_mul_epu32(a, b);
+  __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// SSE2 has no floor, truncate and step down where truncation rounded up
+static inline __m128 FloorLanes(__m128 x)
+{
+  __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+  return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.0f)));
+}
+
+static inline __m128 SelectLanes(__m128 mask, __m128 a, __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128i HashNoiseCellLanes(__m128i hashX, __m128i hashY, __m128i seed)
+{
+  __m128i hash = _mm_xor_si128(seed, _mm_xor_si128(hashX, hashY));
+  hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 15));
+  hash = MultiplyLow32(hash, _mm_set1_epi32((int)NOISE_HASH_MIX));
+  return _mm_xor_si128(hash, _mm_srli_epi32(hash, 13));
+}
+
+static inline __m128 GradientDotLanes(__m128i hash, __m128 x, __m128 y)
+{
+  __m128i one = _mm_set1_epi32(1);
+  __m128i two = _mm_set1_epi32(2);
+  __m128i four = _mm_set1_epi32(4);
+  __m128 signX = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(hash, one), 31));
+  __m128 signY = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(hash, two), 30));
+  __m128 axis = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(hash, four), four));
+  __m128 pickY = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(hash, one), one));
+
+  // Sign flips are exact, so xor with the sign bit matches the scalar multiply by -1
+  __m128 axisDot = _mm_add_ps(_mm_xor_ps(SelectLanes(pickY, y, x), signY), _mm_setzero_ps());
+  __m128 diagonalDot = _mm_add_ps(_mm_xor_ps(x, signX), _mm_xor_ps(y, signY));
+  return SelectLanes(axis, axisDot, diagonalDot);
+}
+
+static inline __m128 NoiseFadeLanes(__m128 t)
+{
+  __m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+  return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+}
+
+// Function to evaluate 4 points at a time, returns the number of points handled
+static int GradientNoise2DLanes(const float *x, const float *y, float *out, int count, uint32_t seed)
+{
+  int i = 0;
+  __m128i seedLanes = _mm_set1_epi32((int)seed);
+  __m128 one = _mm_set1_ps(1.0f);
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 px = _mm_loadu_ps(x + i);
+    __m128 py = _mm_loadu_ps(y + i);
+    __m128 floorX = FloorLanes(px);
+    __m128 floorY = FloorLanes(py);
+    __m128 fx = _mm_sub_ps(px, floorX);
+    __m128 fy = _mm_sub_ps(py, floorY);
+
+    __m128i hashX0 = MultiplyLow32(_mm_cvttps_epi32(floorX), _mm_set1_epi32((int)NOISE_HASH_X));
+    __m128i hashY0 = MultiplyLow32(_mm_cvttps_epi32(floorY), _mm_set1_epi32((int)NOISE_HASH_Y));
+    __m128i hashX1 = _mm_add_epi32(hashX0, _mm_set1_epi32((int)NOISE_HASH_X));
+    __m128i hashY1 = _mm_add_epi32(hashY0, _mm_set1_epi32((int)NOISE_HASH_Y));
+
+    __m128 fx1 = _mm_sub_ps(fx, one);
+    __m128 fy1 = _mm_sub_ps(fy, one);
+    __m128 g00 = GradientDotLanes(HashNoiseCellLanes(hashX0, hashY0, seedLanes), fx, fy);
+    __m128 g10 = GradientDotLanes(HashNoiseCellLanes(hashX1, hashY0, seedLanes), fx1, fy);
+    __m128 g01 = GradientDotLanes(HashNoiseCellLanes(hashX0, hashY1, seedLanes), fx, fy1);
+    __m128 g11 = GradientDotLanes(HashNoiseCellLanes(hashX1, hashY1, seedLanes), fx1, fy1);
+
+    __m128 u = NoiseFadeLanes(fx);
+    __m128 v = NoiseFadeLanes(fy);
+    __m128 a = _mm_add_ps(g00, _mm_mul_ps(u, _mm_sub_ps(g10, g00)));
+    __m128 b = _mm_add_ps(g01, _mm_mul_ps(u, _mm_sub_ps(g11, g01)));
+    _mm_storeu_ps(out + i, _mm_add_ps(a, _mm_mul_ps(v, _mm_sub_ps(b, a))));
+  }
+  return i;
+}
+
+#else
+
+static int GradientNoise2DLanes(const float *x, const float *y, float *out, int count, uint32_t seed)
+{
+  (void)x;
+  (void)y;
+  (void)out;
+  (void)count;
+  (void)seed;
+  return 0;
+}
+
+#endif
+
+void GradientNoise2DBatch(const float *x, const float *y, float *out, int count, uint32_t seed)
+{
+  // SIMD lanes first, the scalar reference handles the tail
+  for (int i = GradientNoise2DLanes(x, y, out, count, seed); i < count; i++)
+  {
+    out[i] = GradientNoise2D(x[i], y[i], seed);
+  }
+}
+
+// Function to sum the octaves of a batch, ridged octaves are folded and squared
+static void FractalNoise2DBatch(const float *x, const float *y, float *out, int count, const NoiseParams *params, bool ridged)
+{
+  float scaledX[NOISE_BATCH_SIZE];
+  float scaledY[NOISE_BATCH_SIZE];
+  float octave[NOISE_BATCH_SIZE];
+
+  for (int start = 0; start < count; start += NOISE_BATCH_SIZE)
+  {
+    int batch = count - start < NOISE_BATCH_SIZE ? count - start : NOISE_BATCH_SIZE;
+    float *sum = out + start;
+    float frequency = params->frequency;
+    float amplitude = 1.0f;
+    float amplitudeSum = 0.0f;
+
+    for (int i = 0; i < batch; i++)
+    {
+      sum[i] = 0.0f;
+    }
+
+    for (int o = 0; o < params->octaves; o++)
+    {
+      for (int i = 0; i < batch; i++)
+      {
+        scaledX[i] = x[start + i] * frequency;
+        scaledY[i] = y[start + i] * frequency;
+      }
+
+      GradientNoise2DBatch(scaledX, scaledY, octave, batch, params->seed + (uint32_t)o);
+
+      for (int i = 0; i < batch; i++)
+      {
+        float n = octave[i];
+        if (ridged)
+        {
+          n = 1.0f - fabsf(n);
+          n *= n;
+        }
+        sum[i] += n * amplitude;
+      }
+
+      amplitudeSum += amplitude;
+      frequency *= params->lacunarity;
+      amplitude *= params->gain;
+    }
+
+    // Normalize so the result range does not depend on the octave count
+    float normalize = amplitudeSum > 0.0f ? 1.0f / amplitudeSum : 0.0f;
+    for (int i = 0; i < batch; i++)
+    {
+      sum[i] *= normalize;
+    }
+  }
+}
+
+void FbmNoise2DBatch(const float *x, const float *y, float *out, int count, const NoiseParams *params)
+{
+  FractalNoise2DBatch(x, y, out, count, params, false);
+}
+
+void RidgedNoise2DBatch(const float *x, const float *y, float *out, int count, const NoiseParams *params)
+{
+  FractalNoise2DBatch(x, y, out, count, params, true);
+}
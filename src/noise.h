@@ -0,0 +1,31 @@
+#ifndef NOISE_H
+#define NOISE_H
+
+#include <stdint.h>
+
+// Largest batch the fractal noise functions process per pass, longer arrays are split
+#define NOISE_BATCH_SIZE 64
+
+// Fractal noise settings, results are deterministic for a given seed
+typedef struct
+{
+  uint32_t seed;    // Seed of the first octave, octave o uses seed + o
+  float frequency;  // Frequency of the first octave
+  float lacunarity; // Frequency multiplier per octave
+  float gain;       // Amplitude multiplier per octave
+  int octaves;      // Number of octaves
+} NoiseParams;
+
+// Function to evaluate 2D gradient noise at one point, result is in [-1, 1]
+float GradientNoise2D(float x, float y, uint32_t seed);
+
+// Function to evaluate 2D gradient noise over arrays of coordinates, matches GradientNoise2D exactly
+void GradientNoise2DBatch(const float *x, const float *y, float *out, int count, uint32_t seed);
+
+// Function to evaluate fractal Brownian motion over arrays of coordinates, result is in [-1, 1]
+void FbmNoise2DBatch(const float *x, const float *y, float *out, int count, const NoiseParams *params);
+
+// Function to evaluate ridged noise over arrays of coordinates, result is in [0, 1] with ridges at 1
+void RidgedNoise2DBatch(const float *x, const float *y, float *out, int count, const NoiseParams *params);
+
+#endif // NOISE_H
@@ -0,0 +1,335 @@
+#include "pipeline.h"
+#include "marching_cubes.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+// Weight of the newest chunk in the stage latency averages
+#define PIPELINE_LATENCY_SMOOTHING 0.1f
+
+// One chunk on its way through the stages
+typedef struct
+{
+  ChunkData *chunkData;
+  ChunkPipelineQueues *queues;
+  double stageStart; // Time the chunk entered its current stage
+  double stageEnd;   // Time it left the stage, set by the stage job
+  bool generated;    // False when the generate stage ran out of memory, the chunk is then requested again
+  SectionMeshData meshes[SECTIONS_PER_AXIS][SECTIONS_PER_AXIS][SECTIONS_PER_AXIS];
+} ChunkTask;
+
+// Bounded FIFO of pointers, pushed by the stage jobs and popped on the GL thread
+typedef struct
+{
+  pthread_mutex_t mutex;
+  void **items; // Ring buffer
+  int capacity;
+  int head;
+  int count;
+} PipelineQueue;
+
+struct ChunkPipelineQueues
+{
+  TerrainParams params; // Copy, the feature grids stay owned by the caller
+  unsigned int seed;
+  PipelineQueue requests;  // ChunkData waiting for the generate stage
+  PipelineQueue generated; // ChunkTask waiting for the mesh stage
+  PipelineQueue meshed;    // ChunkTask waiting for the upload stage
+};
+
+static bool InitializePipelineQueue(PipelineQueue *queue, int capacity)
+{
+  queue->items = (void **)RL_MALLOC(capacity * sizeof(void *));
+  queue->capacity = capacity;
+  queue->head = 0;
+  queue->count = 0;
+  pthread_mutex_init(&queue->mutex, NULL);
+  return queue->items != NULL;
+}
+
+static void CleanupPipelineQueue(PipelineQueue *queue)
+{
+  pthread_mutex_destroy(&queue->mutex);
+  RL_FREE(queue->items);
+  queue->items = NULL;
+}
+
+// Function to append an item, returns false when the queue is full
+static bool PushPipelineQueue(PipelineQueue *queue, void *item)
+{
+  pthread_mutex_lock(&queue->mutex);
+  bool pushed = queue->count < queue->capacity;
+  if (pushed)
+  {
+    queue->items[(queue->head + queue->count) % queue->capacity] = item;
+    queue->count++;
+  }
+  pthread_mutex_unlock(&queue->mutex);
+  return pushed;
+}
+
+// Function to take the oldest item, returns NULL when the queue is empty
+static void *PopPipelineQueue(PipelineQueue *queue)
+{
+  void *item = NULL;
+  pthread_mutex_lock(&queue->mutex);
+  if (queue->count > 0)
+  {
+    item = queue->items[queue->head];
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->count--;
+  }
+  pthread_mutex_unlock(&queue->mutex);
+  return item;
+}
+
+// Function to get the oldest item without taking it, returns NULL when the queue is empty
+static void *PeekPipelineQueue(PipelineQueue *queue)
+{
+  pthread_mutex_lock(&queue->mutex);
+  void *item = queue->count > 0 ? queue->items[queue->head] : NULL;
+  pthread_mutex_unlock(&queue->mutex);
+  return item;
+}
+
+static int GetPipelineQueueCount(PipelineQueue *queue)
+{
+  pthread_mutex_lock(&queue->mutex);
+  int count = queue->count;
+  pthread_mutex_unlock(&queue->mutex);
+  return count;
+}
+
+// Function to add the time a chunk spent in a stage to its statistics
+static void RecordStageLatency(PipelineStageStats *stats, const ChunkTask *task)
+{
+  float ms = (float)((task->stageEnd - task->stageStart) * 1000.0);
+  stats->averageMs = stats->completed == 0 ? ms : stats->averageMs + (ms - stats->averageMs) * PIPELINE_LATENCY_SMOOTHING;
+  stats->maxMs = fmaxf(stats->maxMs, ms);
+  stats->completed++;
+}
+
+// Job function of the generate stage, data is a ChunkTask
+static void GenerateStageJob(void *data)
+{
+  ChunkTask *task = (ChunkTask *)data;
+  ChunkPipelineQueues *queues = task->queues;
+
+  task->generated = GenerateChunkDensity(&task->chunkData->chunk, queues->seed, &queues->params, &task->chunkData->heightfield);
+  task->stageEnd = GetTime();
+
+  // Room was reserved when the chunk entered the stage
+  PushPipelineQueue(&queues->generated, task);
+}
+
+// Job function of the mesh stage, data is a ChunkTask
+static void MeshStageJob(void *data)
+{
+  ChunkTask *task = (ChunkTask *)data;
+
+  // Without a meshing context the chunk is uploaded empty, as a failed InitializeMeshingContext did
+  MeshingContext *context = GetThreadMeshingContext();
+  for (int sx = 0; sx < SECTIONS_PER_AXIS; sx++)
+  {
+    for (int sy = 0; sy < SECTIONS_PER_AXIS; sy++)
+    {
+      for (int sz = 0; sz < SECTIONS_PER_AXIS; sz++)
+      {
+        SectionMeshData empty = {0};
+        task->meshes[sx][sy][sz] = context ? BuildSectionMesh(context, &task->chunkData->chunk, sx, sy, sz) : empty;
+      }
+    }
+  }
+  task->stageEnd = GetTime();
+
+  // Room was reserved when the chunk entered the stage
+  PushPipelineQueue(&task->queues->meshed, task);
+}
+
+// Function to upload the section meshes of a chunk into the world mesh and retire its preview
+static void UploadChunkTask(ChunkPipeline *pipeline, ChunkTask *task)
+{
+  ChunkData *chunkData = task->chunkData;
+
+  for (int sx = 0; sx < SECTIONS_PER_AXIS; sx++)
+  {
+    for (int sy = 0; sy < SECTIONS_PER_AXIS; sy++)
+    {
+      for (int sz = 0; sz < SECTIONS_PER_AXIS; sz++)
+      {
+        UpdateChunkSectionMesh(pipeline->worldMesh, chunkData, sx, sy, sz, &task->meshes[sx][sy][sz]);
+      }
+    }
+  }
+
+  UnloadChunkPreviewMesh(pipeline->worldMesh, chunkData);
+  chunkData->initialized = true;
+}
+
+ChunkPipeline InitializeChunkPipeline(JobSystem *jobSystem, WorldMesh *worldMesh, const TerrainParams *params, unsigned int seed, int capacity)
+{
+  ChunkPipeline pipeline = {0};
+  pipeline.jobSystem = jobSystem;
+  pipeline.worldMesh = worldMesh;
+  pipeline.capacity = capacity > 0 ? capacity : 2 * (jobSystem->threadCount + 1);
+
+  ChunkPipelineQueues *queues = (ChunkPipelineQueues *)RL_CALLOC(1, sizeof(ChunkPipelineQueues));
+  if (!queues)
+    return pipeline;
+
+  queues->params = *params;
+  queues->seed = seed;
+  bool allocated = InitializePipelineQueue(&queues->requests, PIPELINE_REQUEST_CAPACITY);
+  allocated = InitializePipelineQueue(&queues->generated, pipeline.capacity) && allocated;
+  allocated = InitializePipelineQueue(&queues->meshed, pipeline.capacity) && allocated;
+  if (!allocated)
+  {
+    CleanupPipelineQueue(&queues->requests);
+    CleanupPipelineQueue(&queues->generated);
+    CleanupPipelineQueue(&queues->meshed);
+    RL_FREE(queues);
+    return pipeline;
+  }
+
+  pipeline.queues = queues;
+  return pipeline;
+}
+
+void CleanupChunkPipeline(ChunkPipeline *pipeline)
+{
+  ChunkPipelineQueues *queues = pipeline->queues;
+  if (!queues)
+    return;
+
+  if (pipeline->generating > 0 || pipeline->meshing > 0)
+    WaitForJobs(pipeline->jobSystem);
+
+  // Chunks that did not reach the upload stage stay uninitialized
+  ChunkTask *task;
+  while ((task = (ChunkTask *)PopPipelineQueue(&queues->generated)))
+  {
+    RL_FREE(task);
+  }
+  while ((task = (ChunkTask *)PopPipelineQueue(&queues->meshed)))
+  {
+    for (int sx = 0; sx < SECTIONS_PER_AXIS; sx++)
+    {
+      for (int sy = 0; sy < SECTIONS_PER_AXIS; sy++)
+      {
+        for (int sz = 0; sz < SECTIONS_PER_AXIS; sz++)
+        {
+          UnloadSectionMeshData(&task->meshes[sx][sy][sz]);
+        }
+      }
+    }
+    RL_FREE(task);
+  }
+
+  CleanupPipelineQueue(&queues->requests);
+  CleanupPipelineQueue(&queues->generated);
+  CleanupPipelineQueue(&queues->meshed);
+  RL_FREE(queues);
+  pipeline->queues = NULL;
+  pipeline->generating = 0;
+  pipeline->meshing = 0;
+}
+
+bool RequestChunk(ChunkPipeline *pipeline, ChunkData *chunkData)
+{
+  if (!pipeline->queues)
+    return false;
+
+  chunkData->initialized = false;
+  return PushPipelineQueue(&pipeline->queues->requests, chunkData);
+}
+
+int UpdateChunkPipeline(ChunkPipeline *pipeline, UploadBudget *budget)
+{
+  ChunkPipelineQueues *queues = pipeline->queues;
+  if (!queues)
+    return 0;
+
+  // Upload stage, here since it needs the GL context, only this thread takes from the meshed queue
+  int uploaded = 0;
+  ChunkTask *task;
+  while ((task = (ChunkTask *)PeekPipelineQueue(&queues->meshed)) &&
+         BeginUpload(budget, GetSectionMeshDataArraySize(&task->meshes[0][0][0], SECTION_COUNT)))
+  {
+    PopPipelineQueue(&queues->meshed);
+    pipeline->meshing--;
+    RecordStageLatency(&pipeline->stats[PIPELINE_STAGE_MESH], task);
+
+    task->stageStart = GetTime();
+    UploadChunkTask(pipeline, task);
+    task->stageEnd = GetTime();
+    EndUpload(budget);
+    RecordStageLatency(&pipeline->stats[PIPELINE_STAGE_UPLOAD], task);
+
+    RL_FREE(task);
+    uploaded++;
+  }
+
+  // Mesh stage, takes generated chunks while the upload queue has room
+  while (pipeline->meshing < pipeline->capacity && (task = (ChunkTask *)PopPipelineQueue(&queues->generated)))
+  {
+    pipeline->generating--;
+    RecordStageLatency(&pipeline->stats[PIPELINE_STAGE_GENERATE], task);
+
+    // A partly filled chunk is not meshed, it goes back to the end of the request queue to be generated again
+    if (!task->generated)
+    {
+      if (!PushPipelineQueue(&queues->requests, task->chunkData))
+        TraceLog(LOG_WARNING, "PIPELINE: Request queue full, chunk left ungenerated");
+      RL_FREE(task);
+      continue;
+    }
+
+    pipeline->meshing++;
+    task->stageStart = GetTime();
+    SubmitJob(pipeline->jobSystem, MeshStageJob, task);
+  }
+
+  // Generate stage, takes requests while the mesh queue has room
+  while (pipeline->generating < pipeline->capacity && GetPipelineQueueCount(&queues->requests) > 0)
+  {
+    task = (ChunkTask *)RL_CALLOC(1, sizeof(ChunkTask));
+    if (!task)
+      break;
+
+    task->chunkData = (ChunkData *)PopPipelineQueue(&queues->requests);
+    task->queues = queues;
+    task->stageStart = GetTime();
+    pipeline->generating++;
+    SubmitJob(pipeline->jobSystem, GenerateStageJob, task);
+  }
+
+  return uploaded;
+}
+
+ChunkPipelineStats GetChunkPipelineStats(const ChunkPipeline *pipeline)
+{
+  ChunkPipelineStats stats = {0};
+  for (int stage = 0; stage < PIPELINE_STAGE_COUNT; stage++)
+  {
+    stats.stages[stage] = pipeline->stats[stage];
+  }
+
+  ChunkPipelineQueues *queues = pipeline->queues;
+  if (!queues)
+    return stats;
+
+  int requested = GetPipelineQueueCount(&queues->requests);
+  int generated = GetPipelineQueueCount(&queues->generated);
+  int meshed = GetPipelineQueueCount(&queues->meshed);
+
+  stats.stages[PIPELINE_STAGE_GENERATE].waiting = requested;
+  stats.stages[PIPELINE_STAGE_GENERATE].running = pipeline->generating - generated;
+  stats.stages[PIPELINE_STAGE_GENERATE].capacity = PIPELINE_REQUEST_CAPACITY;
+  stats.stages[PIPELINE_STAGE_MESH].waiting = generated;
+  stats.stages[PIPELINE_STAGE_MESH].running = pipeline->meshing - meshed;
+  stats.stages[PIPELINE_STAGE_MESH].capacity = pipeline->capacity;
+  stats.stages[PIPELINE_STAGE_UPLOAD].waiting = meshed;
+  stats.stages[PIPELINE_STAGE_UPLOAD].running = 0;
+  stats.stages[PIPELINE_STAGE_UPLOAD].capacity = pipeline->capacity;
+  return stats;
+}
@@ -0,0 +1,70 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "raylib.h"
+#include "chunk.h"
+#include "generator.h"
+#include "jobs.h"
+#include "upload_budget.h"
+#include "world_mesh.h"
+
+// Chunk requests that can wait for the generation stage
+#define PIPELINE_REQUEST_CAPACITY 64
+
+// Stages a chunk goes through, in order
+typedef enum
+{
+  PIPELINE_STAGE_GENERATE, // Heightfield and densities, on the workers
+  PIPELINE_STAGE_MESH,     // Section meshes on the CPU, on the workers
+  PIPELINE_STAGE_UPLOAD,   // GPU buffers and model, on the thread that owns the GL context
+  PIPELINE_STAGE_COUNT
+} PipelineStage;
+
+// Load of one stage, for tuning queue capacities and worker counts
+typedef struct
+{
+  int waiting;     // Chunks queued in front of the stage
+  int running;     // Chunks inside the stage
+  int capacity;    // Bound of the queue in front of the stage
+  int completed;   // Chunks that left the stage
+  float averageMs; // Moving average of the time from entering to leaving the stage, queueing for a worker included
+  float maxMs;
+} PipelineStageStats;
+
+typedef struct
+{
+  PipelineStageStats stages[PIPELINE_STAGE_COUNT];
+} ChunkPipelineStats;
+
+// Stage queues and the terrain settings the stage jobs generate from
+typedef struct ChunkPipelineQueues ChunkPipelineQueues;
+
+// Generate, mesh and upload stages joined by bounded queues
+// A stage only takes a chunk when the queue behind it has room, so at most a few half-built chunks exist at once
+typedef struct
+{
+  JobSystem *jobSystem;
+  ChunkPipelineQueues *queues;
+  WorldMesh *worldMesh; // Receives the meshes of finished chunks
+  int capacity;         // Bound of the queues between the stages, chunks running in the stage before included
+  int generating;       // Chunks generating or waiting for the mesh stage
+  int meshing;          // Chunks meshing or waiting for the upload stage
+  PipelineStageStats stats[PIPELINE_STAGE_COUNT];
+} ChunkPipeline;
+
+// Pipeline management, capacity 0 picks two chunks per thread, cleanup waits for the running stages
+ChunkPipeline InitializeChunkPipeline(JobSystem *jobSystem, WorldMesh *worldMesh, const TerrainParams *params, unsigned int seed, int capacity);
+void CleanupChunkPipeline(ChunkPipeline *pipeline);
+
+// Function to queue a chunk for production, its position must be set and it stays uninitialized until uploaded
+// Returns false when the request queue is full, requests are served in order
+bool RequestChunk(ChunkPipeline *pipeline, ChunkData *chunkData);
+
+// Function to advance every stage, call once per frame on the GL thread, returns the number of chunks uploaded
+// Meshed chunks are uploaded in request order while budget is left, budget may be NULL
+int UpdateChunkPipeline(ChunkPipeline *pipeline, UploadBudget *budget);
+
+// Function to get the queue depths and stage latencies
+ChunkPipelineStats GetChunkPipelineStats(const ChunkPipeline *pipeline);
+
+#endif // PIPELINE_H
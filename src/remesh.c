@@ -0,0 +1,229 @@
+#include "remesh.h"
+#include "marching_cubes.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// Dirty sections of one chunk, meshed from a copy of its voxels
+typedef struct RemeshRequest
+{
+  RemeshQueue *queue;
+  ChunkData *chunkData; // Chunk the finished meshes are swapped into
+  Chunk snapshot;       // Voxels as they were when the request was made, freed by the worker
+  bool meshed;          // False when the worker had no meshing context, the sections are requested again
+  int sectionCount;
+  int sections[SECTION_COUNT][3];
+  SectionMeshData meshes[SECTION_COUNT];
+  struct RemeshRequest *next; // Next finished request
+} RemeshRequest;
+
+struct RemeshQueue
+{
+  _Atomic(RemeshRequest *) finished; // Lock-free stack, pushed by workers and taken whole by the render thread
+  atomic_int inFlight;               // Requests submitted and not yet applied
+  RemeshRequest *waiting;            // Finished requests waiting for upload budget, render thread only
+};
+
+// Function to free a request whose meshes will not be uploaded
+static void DiscardRemeshRequest(RemeshRequest *request)
+{
+  for (int i = 0; i < request->sectionCount; i++)
+  {
+    UnloadSectionMeshData(&request->meshes[i]);
+  }
+  request->chunkData->remeshing = false;
+  RL_FREE(request);
+}
+
+// Job function meshing the sections of a RemeshRequest, then handing it back to the render thread
+static void RemeshJob(void *data)
+{
+  RemeshRequest *request = (RemeshRequest *)data;
+
+  MeshingContext *context = GetThreadMeshingContext();
+  request->meshed = context != NULL;
+  for (int i = 0; i < request->sectionCount; i++)
+  {
+    const int *section = request->sections[i];
+    SectionMeshData empty = {0};
+    request->meshes[i] = context ? BuildSectionMesh(context, &request->snapshot, section[0], section[1], section[2]) : empty;
+  }
+  CleanupChunk(&request->snapshot);
+
+  // Push onto the finished stack, the release pairs with the acquire in ApplyRemeshResults
+  RemeshQueue *queue = request->queue;
+  RemeshRequest *head = atomic_load_explicit(&queue->finished, memory_order_relaxed);
+  do
+  {
+    request->next = head;
+  } while (!atomic_compare_exchange_weak_explicit(&queue->finished, &head, request,
+                                                  memory_order_release, memory_order_relaxed));
+}
+
+RemeshService InitializeRemeshService(JobSystem *jobSystem, WorldMesh *worldMesh)
+{
+  RemeshService service = {0};
+  service.jobSystem = jobSystem;
+  service.worldMesh = worldMesh;
+  service.queue = (RemeshQueue *)RL_MALLOC(sizeof(RemeshQueue));
+  if (service.queue)
+  {
+    atomic_init(&service.queue->finished, NULL);
+    atomic_init(&service.queue->inFlight, 0);
+    service.queue->waiting = NULL;
+  }
+  return service;
+}
+
+void CleanupRemeshService(RemeshService *service)
+{
+  if (!service->queue)
+    return;
+
+  if (atomic_load(&service->queue->inFlight) > 0)
+    WaitForJobs(service->jobSystem);
+
+  RemeshRequest *lists[2] = {atomic_exchange(&service->queue->finished, NULL), service->queue->waiting};
+  for (int i = 0; i < 2; i++)
+  {
+    RemeshRequest *request = lists[i];
+    while (request)
+    {
+      RemeshRequest *next = request->next;
+      DiscardRemeshRequest(request);
+      request = next;
+    }
+  }
+  service->waiting = 0;
+
+  RL_FREE(service->queue);
+  service->queue = NULL;
+}
+
+bool RequestChunkRemesh(RemeshService *service, ChunkData *chunkData)
+{
+  // One request per chunk at a time, so results can never be swapped in out of order
+  if (chunkData->remeshing || !service->queue)
+    return false;
+
+  RemeshRequest *request = (RemeshRequest *)RL_MALLOC(sizeof(RemeshRequest));
+  if (!request)
+    return false;
+
+  if (!CopyChunk(&request->snapshot, &chunkData->chunk))
+  {
+    RL_FREE(request);
+    return false;
+  }
+
+  request->queue = service->queue;
+  request->chunkData = chunkData;
+  request->sectionCount = 0;
+  request->next = NULL;
+
+  // Sections edited after the snapshot are flagged dirty again and go into the next request
+  for (int sx = 0; sx < SECTIONS_PER_AXIS; sx++)
+  {
+    for (int sy = 0; sy < SECTIONS_PER_AXIS; sy++)
+    {
+      for (int sz = 0; sz < SECTIONS_PER_AXIS; sz++)
+      {
+        ChunkSection *section = &chunkData->sections[sx][sy][sz];
+        if (!section->dirty)
+          continue;
+
+        int *entry = request->sections[request->sectionCount++];
+        entry[0] = sx;
+        entry[1] = sy;
+        entry[2] = sz;
+        section->dirty = false;
+      }
+    }
+  }
+
+  if (request->sectionCount == 0)
+  {
+    CleanupChunk(&request->snapshot);
+    RL_FREE(request);
+    return true;
+  }
+
+  chunkData->remeshing = true;
+  atomic_fetch_add(&service->queue->inFlight, 1);
+  SubmitJob(service->jobSystem, RemeshJob, request);
+  return true;
+}
+
+int ApplyRemeshResults(RemeshService *service, UploadBudget *budget)
+{
+  RemeshQueue *queue = service->queue;
+  if (!queue)
+    return 0;
+
+  // Move the newly finished requests to the waiting list
+  RemeshRequest *request = atomic_exchange_explicit(&queue->finished, NULL, memory_order_acquire);
+  while (request)
+  {
+    RemeshRequest *next = request->next;
+    request->next = queue->waiting;
+    queue->waiting = request;
+    service->waiting++;
+    request = next;
+  }
+
+  int swapped = 0;
+  while (queue->waiting)
+  {
+    // Most urgent chunk first, at most one request per chunk waits so a linear scan is cheap
+    RemeshRequest **link = &queue->waiting;
+    if (budget)
+    {
+      float bestPriority = GetChunkUploadPriority(budget, (*link)->chunkData);
+      for (RemeshRequest **candidate = &(*link)->next; *candidate; candidate = &(*candidate)->next)
+      {
+        float priority = GetChunkUploadPriority(budget, (*candidate)->chunkData);
+        if (priority < bestPriority)
+        {
+          bestPriority = priority;
+          link = candidate;
+        }
+      }
+    }
+
+    // All sections of a chunk are swapped in the same frame, so edits never show seams inside a chunk
+    request = *link;
+    if (!request->meshed)
+    {
+      // Flag the sections dirty again so the next request retries them
+      for (int i = 0; i < request->sectionCount; i++)
+      {
+        const int *section = request->sections[i];
+        request->chunkData->sections[section[0]][section[1]][section[2]].dirty = true;
+      }
+      request->chunkData->needsUpdate = true;
+      *link = request->next;
+      service->waiting--;
+      atomic_fetch_sub(&queue->inFlight, 1);
+      DiscardRemeshRequest(request);
+      continue;
+    }
+
+    if (!BeginUpload(budget, GetSectionMeshDataArraySize(request->meshes, request->sectionCount)))
+      break;
+
+    for (int i = 0; i < request->sectionCount; i++)
+    {
+      const int *section = request->sections[i];
+      UpdateChunkSectionMesh(service->worldMesh, request->chunkData, section[0], section[1], section[2], &request->meshes[i]);
+      swapped++;
+    }
+    EndUpload(budget);
+
+    *link = request->next;
+    service->waiting--;
+    request->chunkData->remeshing = false;
+    atomic_fetch_sub(&queue->inFlight, 1);
+    RL_FREE(request);
+  }
+
+  return swapped;
+}
@@ -0,0 +1,33 @@
+#ifndef REMESH_H
+#define REMESH_H
+
+#include "chunk.h"
+#include "jobs.h"
+#include "upload_budget.h"
+#include "world_mesh.h"
+
+// Requests finished by the workers and the count still in flight
+typedef struct RemeshQueue RemeshQueue;
+
+// Meshes edited chunks on job system workers, the render thread only uploads and swaps the results
+typedef struct
+{
+  JobSystem *jobSystem;
+  WorldMesh *worldMesh; // Receives the finished section meshes
+  RemeshQueue *queue;
+  int waiting; // Finished requests held back by the upload budget
+} RemeshService;
+
+// Remesh service management, cleanup waits for requests in flight and discards their meshes
+RemeshService InitializeRemeshService(JobSystem *jobSystem, WorldMesh *worldMesh);
+void CleanupRemeshService(RemeshService *service);
+
+// Function to snapshot the dirty sections of a chunk and mesh them on a worker
+// Returns false when nothing was submitted because a request for the chunk is still in flight or memory ran out
+bool RequestChunkRemesh(RemeshService *service, ChunkData *chunkData);
+
+// Function to upload the finished meshes and swap them into their chunks, returns the number of sections swapped
+// Chunks are uploaded whole in order of GetChunkUploadPriority until the budget runs out, budget may be NULL
+int ApplyRemeshResults(RemeshService *service, UploadBudget *budget);
+
+#endif // REMESH_H
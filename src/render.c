@@ -2,6 +2,7 @@
 #include "raymath.h"
 #include "rlgl.h"
 #include "chunk.h"
+#include "marching_cubes.h"
 #include <stdlib.h>
 
 #define CROSSHAIR_SIZE 10
@@ -84,6 +85,10 @@ void InitializeShader(Shader *shader)
   float blendFactor = 1.2f;
   SetShaderValue(*shader, GetShaderLocation(*shader, "blendFactor"), (float[1]){blendFactor}, SHADER_UNIFORM_FLOAT);
 
+  // Chunk meshes store fixed-point positions, see ChunkVertex
+  float positionScale = VOXEL_SIZE / CHUNK_POSITION_STEPS;
+  SetShaderValue(*shader, GetShaderLocation(*shader, "positionScale"), (float[1]){positionScale}, SHADER_UNIFORM_FLOAT);
+
   // Set lighting parameters
   SetShaderValue(*shader, GetShaderLocation(*shader, "lightColor"), (float[3]){1.0f, 1.0f, 1.0f}, SHADER_UNIFORM_VEC3);
   SetShaderValue(*shader, GetShaderLocation(*shader, "lightPos"), (float[3]){50.0f, 50.0f, 50.0f}, SHADER_UNIFORM_VEC3);
@@ -165,13 +170,13 @@ void CleanupRenderContext(RenderContext *context)
   }
 }
 
-void RenderSceneWithSSAO(RenderContext *context, Camera camera, Model model)
+void RenderSceneWithSSAO(RenderContext *context, Camera camera, SceneDrawFunction drawScene, void *data)
 {
   // 1. Render scene to G-buffer
   BeginTextureMode(context->gBuffer);
   ClearBackground(RAYWHITE);
   BeginMode3D(camera);
-  DrawModel(model, (Vector3){0}, 1.0f, WHITE);
+  drawScene(data);
   EndMode3D();
   EndTextureMode();
 
@@ -200,7 +205,7 @@ void RenderSceneWithSSAO(RenderContext *context, Camera camera, Model model)
 
   // Draw scene with lighting and SSAO
   BeginMode3D(camera);
-  DrawModel(model, (Vector3){0}, 1.0f, WHITE);
+  drawScene(data);
   EndMode3D();
   EndShaderMode();
 }
@@ -270,7 +275,7 @@ void UpdateWater(RenderContext *context, float deltaTime)
                  &time, SHADER_UNIFORM_FLOAT);
 }
 
-void RenderWater(RenderContext *context, Camera camera, Model terrain)
+void RenderWater(RenderContext *context, Camera camera, SceneDrawFunction drawTerrain, void *data)
 {
   // Store current camera position
   Vector3 cameraPos = camera.position;
@@ -283,7 +288,7 @@ void RenderWater(RenderContext *context, Camera camera, Model terrain)
   BeginTextureMode(context->reflectionBuffer);
   ClearBackground(SKYBLUE); // Changed from RAYWHITE to match sky color
   BeginMode3D(camera);
-  DrawModel(terrain, (Vector3){0, 0, 0}, 1.0f, WHITE);
+  drawTerrain(data);
   EndMode3D();
   EndTextureMode();
 
@@ -296,7 +301,7 @@ void RenderWater(RenderContext *context, Camera camera, Model terrain)
   BeginTextureMode(context->refractionBuffer);
   ClearBackground(SKYBLUE); // Changed from RAYWHITE to match sky color
   BeginMode3D(camera);
-  DrawModel(terrain, (Vector3){0, 0, 0}, 1.0f, WHITE);
+  drawTerrain(data);
   EndMode3D();
   EndTextureMode();
 
@@ -353,17 +358,102 @@ void CleanupWater(RenderContext *context)
   UnloadRenderTexture(context->refractionBuffer);
 }
 
-// Implementation of minimap functions
-void GenerateMinimap(RenderContext *context)
+// Function to find the highest solid voxel of a column, skipping bricks that are all air
+static int FindSurfaceHeight(const Chunk *chunk, int vx, int vz)
+{
+  for (int by = BRICKS_PER_AXIS - 1; by >= 0; by--)
+  {
+    const Brick *brick = &chunk->bricks[vx / BRICK_SIZE][by][vz / BRICK_SIZE];
+    if (brick->minDensity > 0)
+      continue;
+    if (brick->maxDensity <= 0)
+      return by * BRICK_SIZE + BRICK_SIZE - 1;
+
+    for (int vy = by * BRICK_SIZE + BRICK_SIZE - 1; vy >= by * BRICK_SIZE; vy--)
+    {
+      if (GetChunkDensity(chunk, vx, vy, vz) <= 0)
+        return vy;
+    }
+  }
+  return 0;
+}
+
+// Minimap pixels of every chunk, shaded by the minimap jobs and drawn afterwards
+typedef struct
+{
+  int mapWidth;  // Pixels per chunk along x
+  int mapHeight; // Pixels per chunk along z
+  Color *pixels; // Indexed [chunkX][chunkZ][xi][zi]
+} MinimapShading;
+
+// Function to shade one pixel column of a chunk on the minimap
+static void ShadeMinimapColumn(void *data, int x, int z, int xi)
 {
   extern ChunkData chunks[CHUNKS_X][CHUNKS_Z];
+  MinimapShading *shading = (MinimapShading *)data;
+  if (!chunks[x][z].initialized)
+    return;
 
-  // Set render target to minimap texture
-  BeginTextureMode(context->minimapTexture);
-  ClearBackground(BLANK);
+  int mapWidth = shading->mapWidth;
+  int mapHeight = shading->mapHeight;
+  Color *column = &shading->pixels[((x * CHUNKS_Z + z) * mapWidth + xi) * mapHeight];
 
-  // Draw a black background
-  DrawRectangle(0, 0, MINIMAP_SIZE, MINIMAP_SIZE, BLACK);
+  for (int zi = 0; zi < mapHeight; zi++)
+  {
+    // Sample height from corresponding position in chunk
+    float sampleX = xi / (float)mapWidth;
+    float sampleZ = zi / (float)mapHeight;
+
+    int vx = (int)(sampleX * CHUNK_SIZE);
+    int vz = (int)(sampleZ * CHUNK_SIZE);
+    vx = Clamp(vx, 0, CHUNK_SIZE - 1);
+    vz = Clamp(vz, 0, CHUNK_SIZE - 1);
+
+    // Find surface height at this point
+    float height = FindSurfaceHeight(&chunks[x][z].chunk, vx, vz);
+
+    // Calculate a height-based color
+    Color color;
+
+    if (height <= 5)
+    {
+      // Water (blue)
+      color = (Color){30, 50, 150, 255};
+    }
+    else if (height <= 10)
+    {
+      // Sand (yellow)
+      color = (Color){194, 178, 128, 255};
+    }
+    else if (height <= 20)
+    {
+      // Grass (green)
+      color = (Color){50, 150, 50, 255};
+    }
+    else if (height <= 30)
+    {
+      // Forest (dark green)
+      color = (Color){25, 100, 25, 255};
+    }
+    else if (height <= 40)
+    {
+      // Rock (brown)
+      color = (Color){110, 85, 65, 255};
+    }
+    else
+    {
+      // Snow (white)
+      color = (Color){220, 220, 255, 255};
+    }
+
+    column[zi] = color;
+  }
+}
+
+// Implementation of minimap functions
+void GenerateMinimap(RenderContext *context)
+{
+  extern ChunkData chunks[CHUNKS_X][CHUNKS_Z];
 
   // Calculate the minimap bounds
   float worldMinX = chunks[0][0].chunk.position.x;
@@ -378,6 +468,20 @@ void GenerateMinimap(RenderContext *context)
   float scaleX = (float)(MINIMAP_SIZE) / worldWidth;
   float scaleZ = (float)(MINIMAP_SIZE) / worldDepth;
 
+  // Shade the chunks on the job system, only drawing has to happen on this thread
+  MinimapShading shading = {.mapWidth = (int)(CHUNK_SIZE * scaleX), .mapHeight = (int)(CHUNK_SIZE * scaleZ)};
+  shading.pixels = (Color *)RL_MALLOC(CHUNKS_X * CHUNKS_Z * shading.mapWidth * shading.mapHeight * sizeof(Color));
+  if (!shading.pixels)
+    return;
+  ParallelFor3D(context->jobSystem, CHUNKS_X, CHUNKS_Z, shading.mapWidth, ShadeMinimapColumn, &shading);
+
+  // Set render target to minimap texture
+  BeginTextureMode(context->minimapTexture);
+  ClearBackground(BLANK);
+
+  // Draw a black background
+  DrawRectangle(0, 0, MINIMAP_SIZE, MINIMAP_SIZE, BLACK);
+
   // Draw terrain height map
   for (int x = 0; x < CHUNKS_X; x++)
   {
@@ -386,87 +490,24 @@ void GenerateMinimap(RenderContext *context)
       if (!chunks[x][z].initialized)
         continue;
 
-      // Get chunk world position
-      Vector3 chunkPos = chunks[x][z].chunk.position;
-
       // Calculate chunk position on minimap
+      Vector3 chunkPos = chunks[x][z].chunk.position;
       int mapX = (int)((chunkPos.x - worldMinX) * scaleX);
       int mapZ = (int)((chunkPos.z - worldMinZ) * scaleZ);
-      int mapWidth = (int)(CHUNK_SIZE * scaleX);
-      int mapHeight = (int)(CHUNK_SIZE * scaleZ);
-
-      // Get height range for this chunk
-      float minHeight = chunks[x][z].minHeight;
-      float maxHeight = chunks[x][z].maxHeight;
+      const Color *pixels = &shading.pixels[(x * CHUNKS_Z + z) * shading.mapWidth * shading.mapHeight];
 
-      // Draw chunk on minimap with color based on height
-      for (int xi = 0; xi < mapWidth; xi++)
+      for (int xi = 0; xi < shading.mapWidth; xi++)
       {
-        for (int zi = 0; zi < mapHeight; zi++)
+        for (int zi = 0; zi < shading.mapHeight; zi++)
         {
-          // Sample height from corresponding position in chunk
-          float sampleX = xi / (float)mapWidth;
-          float sampleZ = zi / (float)mapHeight;
-
-          int vx = (int)(sampleX * CHUNK_SIZE);
-          int vz = (int)(sampleZ * CHUNK_SIZE);
-          vx = Clamp(vx, 0, CHUNK_SIZE - 1);
-          vz = Clamp(vz, 0, CHUNK_SIZE - 1);
-
-          // Find surface height at this point
-          float height = 0;
-          for (int vy = CHUNK_SIZE - 1; vy >= 0; vy--)
-          {
-            if (chunks[x][z].chunk.voxels[vx][vy][vz].density <= 0)
-            {
-              height = vy;
-              break;
-            }
-          }
-
-          // Calculate a height-based color
-          float heightFactor = (height - minHeight) / (maxHeight - minHeight + 0.1f);
-          Color color;
-
-          if (height <= 5)
-          {
-            // Water (blue)
-            color = (Color){30, 50, 150, 255};
-          }
-          else if (height <= 10)
-          {
-            // Sand (yellow)
-            color = (Color){194, 178, 128, 255};
-          }
-          else if (height <= 20)
-          {
-            // Grass (green)
-            color = (Color){50, 150, 50, 255};
-          }
-          else if (height <= 30)
-          {
-            // Forest (dark green)
-            color = (Color){25, 100, 25, 255};
-          }
-          else if (height <= 40)
-          {
-            // Rock (brown)
-            color = (Color){110, 85, 65, 255};
-          }
-          else
-          {
-            // Snow (white)
-            color = (Color){220, 220, 255, 255};
-          }
-
-          // Draw pixel
-          DrawPixel(mapX + xi, mapZ + zi, color);
+          DrawPixel(mapX + xi, mapZ + zi, pixels[xi * shading.mapHeight + zi]);
         }
       }
     }
   }
 
   EndTextureMode();
+  RL_FREE(shading.pixels);
   context->minimapInitialized = true;
 }
 
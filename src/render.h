@@ -2,6 +2,7 @@
 #define RENDER_H
 
 #include "raylib.h"
+#include "jobs.h"
 
 // SSAO configuration
 #define SSAO_KERNEL_SIZE 16
@@ -36,19 +37,23 @@ typedef struct
   RenderTexture2D minimapTexture;   // Minimap texture
   bool minimapInitialized;          // Whether minimap has been generated
   int minimapUpdateCounter;         // Counter for minimap updates
+  JobSystem *jobSystem;             // Shades minimap rebuilds, NULL shades them on the calling thread
 } RenderContext;
 
+// Function drawing the terrain, called between BeginMode3D and EndMode3D once per render pass
+typedef void (*SceneDrawFunction)(void *data);
+
 // Function declarations for rendering
 void DrawCrosshair(int screenWidth, int screenHeight, Color color);
 void InitializeShader(Shader *shader);
 RenderContext InitializeRenderContext(int width, int height);
 void CleanupRenderContext(RenderContext *context);
-void RenderSceneWithSSAO(RenderContext *context, Camera camera, Model model);
+void RenderSceneWithSSAO(RenderContext *context, Camera camera, SceneDrawFunction drawScene, void *data);
 
 // Water-related functions
 void InitializeWaterMesh(RenderContext *context);
 void UpdateWater(RenderContext *context, float deltaTime);
-void RenderWater(RenderContext *context, Camera camera, Model terrain);
+void RenderWater(RenderContext *context, Camera camera, SceneDrawFunction drawTerrain, void *data);
 void CleanupWater(RenderContext *context);
 
 // Minimap-related functions
@@ -45,7 +45,143 @@ bool GetChunkCoords(Vector3 worldPos, int *chunkX, int *chunkZ, int *vx, int *vy
   return true;
 }
 
-void ModifyTerrain(Vector3 position, float radius, float strength)
+// Function to flag the sections whose meshes read any voxel in the given range
+static void MarkSectionsDirty(ChunkData *chunkData, int minX, int minY, int minZ, int maxX, int maxY, int maxZ)
+{
+  // A voxel is a corner of the cells on both sides of it, and normals take
+  // central differences, so cells up to two voxels away see the change
+  int minSection[3] = {(minX - 2) / SECTION_SIZE, (minY - 2) / SECTION_SIZE, (minZ - 2) / SECTION_SIZE};
+  int maxSection[3] = {(maxX + 1) / SECTION_SIZE, (maxY + 1) / SECTION_SIZE, (maxZ + 1) / SECTION_SIZE};
+  for (int axis = 0; axis < 3; axis++)
+  {
+    minSection[axis] = Clamp(minSection[axis], 0, SECTIONS_PER_AXIS - 1);
+    maxSection[axis] = Clamp(maxSection[axis], 0, SECTIONS_PER_AXIS - 1);
+  }
+
+  for (int sx = minSection[0]; sx <= maxSection[0]; sx++)
+  {
+    for (int sy = minSection[1]; sy <= maxSection[1]; sy++)
+    {
+      for (int sz = minSection[2]; sz <= maxSection[2]; sz++)
+      {
+        chunkData->sections[sx][sy][sz].dirty = true;
+      }
+    }
+  }
+}
+
+// Brush stroke shared by the ModifyTerrain slab jobs
+typedef struct
+{
+  Vector3 position;
+  float radius;
+  float strength;
+  int minChunkX;
+  int minChunkZ;
+  bool modified[CHUNKS_X][CHUNKS_Z][BRICKS_PER_AXIS]; // Written by the job of each slab
+} TerrainEdit;
+
+// Function to get the voxel range of a chunk a brush stroke can reach, clamped to the chunk
+static void GetEditVoxelRange(const TerrainEdit *edit, Vector3 chunkPos, int min[3], int max[3])
+{
+  // Convert world position to local chunk space
+  Vector3 localPos = Vector3Subtract(edit->position, chunkPos);
+  float local[3] = {localPos.x, localPos.y, localPos.z};
+
+  for (int axis = 0; axis < 3; axis++)
+  {
+    min[axis] = (int)((local[axis] - edit->radius) / VOXEL_SIZE);
+    max[axis] = (int)((local[axis] + edit->radius) / VOXEL_SIZE) + 1;
+    min[axis] = min[axis] < 0 ? 0 : min[axis];
+    max[axis] = max[axis] >= CHUNK_SIZE ? CHUNK_SIZE - 1 : max[axis];
+  }
+}
+
+// Function to apply a brush stroke to one brick-wide slab along x of a chunk
+// Slabs share no bricks, so the slabs of a stroke run in parallel
+static void ModifyChunkSlab(void *data, int chunkOffsetX, int chunkOffsetZ, int slab)
+{
+  TerrainEdit *edit = (TerrainEdit *)data;
+  int cx = edit->minChunkX + chunkOffsetX;
+  int cz = edit->minChunkZ + chunkOffsetZ;
+
+  // Chunks still generating in the background are not edited
+  if (!chunks[cx][cz].initialized)
+    return;
+
+  Vector3 position = edit->position;
+  float radius = edit->radius;
+  float strength = edit->strength;
+  float radiusSq = radius * radius;
+  Vector3 chunkPos = chunks[cx][cz].chunk.position;
+
+  int min[3], max[3];
+  GetEditVoxelRange(edit, chunkPos, min, max);
+  int minX = min[0] > slab * BRICK_SIZE ? min[0] : slab * BRICK_SIZE;
+  int maxX = max[0] < slab * BRICK_SIZE + BRICK_SIZE - 1 ? max[0] : slab * BRICK_SIZE + BRICK_SIZE - 1;
+
+  // Only check voxels within the calculated range
+  for (int x = minX; x <= maxX; x++)
+  {
+    for (int y = min[1]; y <= max[1]; y++)
+    {
+      for (int z = min[2]; z <= max[2]; z++)
+      {
+        // Convert voxel position to world space for distance check
+        Vector3 voxelPos = {
+            chunkPos.x + x * VOXEL_SIZE,
+            chunkPos.y + y * VOXEL_SIZE,
+            chunkPos.z + z * VOXEL_SIZE};
+
+        float distSq = Vector3DistanceSqr(position, voxelPos);
+
+        if (distSq <= radiusSq)
+        {
+          // Calculate horizontal distance (ignoring Y component)
+          Vector3 horizontalDiff = {
+              voxelPos.x - position.x,
+              0,
+              voxelPos.z - position.z};
+          float horizontalDistSq = Vector3LengthSqr(horizontalDiff);
+
+          // Calculate vertical distance and direction
+          float verticalDist = voxelPos.y - position.y;
+          float verticalFactor = 1.0f - (fabsf(verticalDist) / radius);
+
+          // Calculate horizontal falloff (smoother transition at edges)
+          float horizontalFactor = 1.0f - (sqrtf(horizontalDistSq) / radius);
+
+          // Calculate base influence that only affects vertical movement
+          float influence = 0;
+
+          if (strength > 0)
+          {
+            // Pull up: stronger effect above the point, weaker below
+            influence = verticalFactor * horizontalFactor * 0.05f * strength;
+            influence *= (verticalDist >= 0) ? 1.2f : 0.8f;
+          }
+          else
+          {
+            // Push down: stronger effect below the point, weaker above
+            influence = verticalFactor * horizontalFactor * 0.05f * strength;
+            influence *= (verticalDist <= 0) ? 1.2f : 0.8f;
+          }
+
+          // Apply influence only if it's significant enough and survives quantization
+          if (fabsf(influence) > 0.001f)
+          {
+            Voxel voxel = GetChunkVoxel(&chunks[cx][cz].chunk, x, y, z);
+            Voxel modified = DensityToVoxel(VoxelToDensity(voxel) + influence);
+            if (modified.density != voxel.density && SetChunkVoxel(&chunks[cx][cz].chunk, x, y, z, modified))
+              edit->modified[cx][cz][slab] = true;
+          }
+        }
+      }
+    }
+  }
+}
+
+void ModifyTerrain(JobSystem *jobs, Vector3 position, float radius, float strength)
 {
   // Calculate affected chunk range
   int minChunkX = (int)((position.x - radius + ((CHUNKS_X * (CHUNK_SIZE - 1)) / 2.0f)) / (CHUNK_SIZE - 1));
@@ -59,98 +195,32 @@ void ModifyTerrain(Vector3 position, float radius, float strength)
   minChunkZ = minChunkZ < 0 ? 0 : minChunkZ;
   maxChunkZ = maxChunkZ >= CHUNKS_Z ? CHUNKS_Z - 1 : maxChunkZ;
 
-  float radiusSq = radius * radius;
+  TerrainEdit edit = {
+      .position = position,
+      .radius = radius,
+      .strength = strength,
+      .minChunkX = minChunkX,
+      .minChunkZ = minChunkZ};
+
+  // Only visit chunks that could be affected, one job item per brick slab
+  ParallelFor3D(jobs, maxChunkX - minChunkX + 1, maxChunkZ - minChunkZ + 1, BRICKS_PER_AXIS, ModifyChunkSlab, &edit);
 
-  // Only iterate over chunks that could be affected
   for (int cx = minChunkX; cx <= maxChunkX; cx++)
   {
     for (int cz = minChunkZ; cz <= maxChunkZ; cz++)
     {
       bool chunkModified = false;
-      Vector3 chunkPos = chunks[cx][cz].chunk.position;
-
-      // Convert world position to local chunk space
-      Vector3 localPos = {
-          position.x - chunkPos.x,
-          position.y - chunkPos.y,
-          position.z - chunkPos.z};
-
-      // Calculate affected voxel range within chunk
-      int minX = (int)((localPos.x - radius) / VOXEL_SIZE);
-      int maxX = (int)((localPos.x + radius) / VOXEL_SIZE) + 1;
-      int minY = (int)((localPos.y - radius) / VOXEL_SIZE);
-      int maxY = (int)((localPos.y + radius) / VOXEL_SIZE) + 1;
-      int minZ = (int)((localPos.z - radius) / VOXEL_SIZE);
-      int maxZ = (int)((localPos.z + radius) / VOXEL_SIZE) + 1;
-
-      // Clamp to chunk bounds
-      minX = minX < 0 ? 0 : minX;
-      maxX = maxX >= CHUNK_SIZE ? CHUNK_SIZE - 1 : maxX;
-      minY = minY < 0 ? 0 : minY;
-      maxY = maxY >= CHUNK_SIZE ? CHUNK_SIZE - 1 : maxY;
-      minZ = minZ < 0 ? 0 : minZ;
-      maxZ = maxZ >= CHUNK_SIZE ? CHUNK_SIZE - 1 : maxZ;
-
-      // Only check voxels within the calculated range
-      for (int x = minX; x <= maxX; x++)
+      for (int slab = 0; slab < BRICKS_PER_AXIS; slab++)
       {
-        for (int y = minY; y <= maxY; y++)
-        {
-          for (int z = minZ; z <= maxZ; z++)
-          {
-            // Convert voxel position to world space for distance check
-            Vector3 voxelPos = {
-                chunkPos.x + x * VOXEL_SIZE,
-                chunkPos.y + y * VOXEL_SIZE,
-                chunkPos.z + z * VOXEL_SIZE};
-
-            float distSq = Vector3DistanceSqr(position, voxelPos);
-
-            if (distSq <= radiusSq)
-            {
-              // Calculate horizontal distance (ignoring Y component)
-              Vector3 horizontalDiff = {
-                  voxelPos.x - position.x,
-                  0,
-                  voxelPos.z - position.z};
-              float horizontalDistSq = Vector3LengthSqr(horizontalDiff);
-
-              // Calculate vertical distance and direction
-              float verticalDist = voxelPos.y - position.y;
-              float verticalFactor = 1.0f - (fabsf(verticalDist) / radius);
-
-              // Calculate horizontal falloff (smoother transition at edges)
-              float horizontalFactor = 1.0f - (sqrtf(horizontalDistSq) / radius);
-
-              // Calculate base influence that only affects vertical movement
-              float influence = 0;
-
-              if (strength > 0)
-              {
-                // Pull up: stronger effect above the point, weaker below
-                influence = verticalFactor * horizontalFactor * 0.05f * strength;
-                influence *= (verticalDist >= 0) ? 1.2f : 0.8f;
-              }
-              else
-              {
-                // Push down: stronger effect below the point, weaker above
-                influence = verticalFactor * horizontalFactor * 0.05f * strength;
-                influence *= (verticalDist <= 0) ? 1.2f : 0.8f;
-              }
-
-              // Apply influence only if it's significant enough
-              if (fabsf(influence) > 0.001f)
-              {
-                chunks[cx][cz].chunk.voxels[x][y][z].density += influence;
-                chunkModified = true;
-              }
-            }
-          }
-        }
+        chunkModified = chunkModified || edit.modified[cx][cz][slab];
       }
 
       if (chunkModified)
       {
+        int min[3], max[3];
+        GetEditVoxelRange(&edit, chunks[cx][cz].chunk.position, min, max);
+        UpdateBrickSummaries(&chunks[cx][cz].chunk, min[0], min[1], min[2], max[0], max[1], max[2]);
+        MarkSectionsDirty(&chunks[cx][cz], min[0], min[1], min[2], max[0], max[1], max[2]);
         chunks[cx][cz].needsUpdate = true;
       }
     }
@@ -160,9 +230,9 @@ void ModifyTerrain(Vector3 position, float radius, float strength)
 bool IsInsideTerrain(Vector3 pos)
 {
   int chunkX, chunkZ, vx, vy, vz;
-  if (GetChunkCoords(pos, &chunkX, &chunkZ, &vx, &vy, &vz))
+  if (GetChunkCoords(pos, &chunkX, &chunkZ, &vx, &vy, &vz) && chunks[chunkX][chunkZ].initialized)
   {
-    return chunks[chunkX][chunkZ].chunk.voxels[vx][vy][vz].density <= 0.0f;
+    return GetChunkDensity(&chunks[chunkX][chunkZ].chunk, vx, vy, vz) <= 0.0f;
   }
   return false;
 }
@@ -170,9 +240,142 @@ bool IsInsideTerrain(Vector3 pos)
 float GetDensityAtPosition(Vector3 pos)
 {
   int chunkX, chunkZ, vx, vy, vz;
-  if (GetChunkCoords(pos, &chunkX, &chunkZ, &vx, &vy, &vz))
+  if (GetChunkCoords(pos, &chunkX, &chunkZ, &vx, &vy, &vz) && chunks[chunkX][chunkZ].initialized)
   {
-    return chunks[chunkX][chunkZ].chunk.voxels[vx][vy][vz].density;
+    return GetChunkDensity(&chunks[chunkX][chunkZ].chunk, vx, vy, vz);
   }
   return 1000.0f; // Return high density for out of bounds
 }
+
+// Function to find the chunk and chunk-local position of a point, using the same
+// placement as the rendered chunk meshes
+static bool GetChunkLocalPosition(Vector3 pos, int *chunkX, int *chunkZ, Vector3 *localPos)
+{
+  Vector3 origin = chunks[0][0].chunk.position;
+  int cx = (int)floorf((pos.x - origin.x) / (CHUNK_SIZE - 1));
+  int cz = (int)floorf((pos.z - origin.z) / (CHUNK_SIZE - 1));
+
+  // The far boundary plane belongs to the last chunk
+  if (cx == CHUNKS_X && pos.x - origin.x <= CHUNKS_X * (CHUNK_SIZE - 1))
+    cx = CHUNKS_X - 1;
+  if (cz == CHUNKS_Z && pos.z - origin.z <= CHUNKS_Z * (CHUNK_SIZE - 1))
+    cz = CHUNKS_Z - 1;
+
+  if (cx < 0 || cx >= CHUNKS_X || cz < 0 || cz >= CHUNKS_Z || !chunks[cx][cz].initialized)
+    return false;
+
+  *localPos = Vector3Subtract(pos, chunks[cx][cz].chunk.position);
+  if (localPos->y < 0.0f || localPos->y > (CHUNK_SIZE - 1) * VOXEL_SIZE)
+    return false;
+
+  *chunkX = cx;
+  *chunkZ = cz;
+  return true;
+}
+
+// Function to sample the trilinearly interpolated density at a chunk-local position
+static float SampleChunkDensity(const Chunk *chunk, Vector3 localPos)
+{
+  float fx = localPos.x / VOXEL_SIZE;
+  float fy = localPos.y / VOXEL_SIZE;
+  float fz = localPos.z / VOXEL_SIZE;
+
+  int x = Clamp((int)fx, 0, CHUNK_SIZE - 2);
+  int y = Clamp((int)fy, 0, CHUNK_SIZE - 2);
+  int z = Clamp((int)fz, 0, CHUNK_SIZE - 2);
+  fx -= x;
+  fy -= y;
+  fz -= z;
+
+  float c00 = Lerp(GetChunkDensity(chunk, x, y, z), GetChunkDensity(chunk, x + 1, y, z), fx);
+  float c01 = Lerp(GetChunkDensity(chunk, x, y, z + 1), GetChunkDensity(chunk, x + 1, y, z + 1), fx);
+  float c10 = Lerp(GetChunkDensity(chunk, x, y + 1, z), GetChunkDensity(chunk, x + 1, y + 1, z), fx);
+  float c11 = Lerp(GetChunkDensity(chunk, x, y + 1, z + 1), GetChunkDensity(chunk, x + 1, y + 1, z + 1), fx);
+
+  return Lerp(Lerp(c00, c01, fz), Lerp(c10, c11, fz), fy);
+}
+
+// Function to get the ray distance at which the ray leaves an all-air brick, or -1 if the
+// interpolation cell at localPos also reads voxels outside that brick
+static float GetAirBrickExit(const Chunk *chunk, Ray ray, float distance, Vector3 localPos)
+{
+  int cell[3] = {(int)(localPos.x / VOXEL_SIZE), (int)(localPos.y / VOXEL_SIZE), (int)(localPos.z / VOXEL_SIZE)};
+  for (int axis = 0; axis < 3; axis++)
+  {
+    if (cell[axis] >= CHUNK_SIZE - 1 || cell[axis] % BRICK_SIZE == BRICK_SIZE - 1)
+      return -1.0f;
+  }
+
+  const Brick *brick = &chunk->bricks[cell[0] / BRICK_SIZE][cell[1] / BRICK_SIZE][cell[2] / BRICK_SIZE];
+  if (brick->minDensity <= 0.0f)
+    return -1.0f;
+
+  // Interpolation stays positive while the ray is inside the brick's voxel box
+  float origin[3] = {localPos.x, localPos.y, localPos.z};
+  float direction[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+  float exit = INFINITY;
+  for (int axis = 0; axis < 3; axis++)
+  {
+    float boxMin = (cell[axis] / BRICK_SIZE) * BRICK_SIZE * VOXEL_SIZE;
+    float boxMax = boxMin + (BRICK_SIZE - 1) * VOXEL_SIZE;
+    if (direction[axis] > 0.0f)
+      exit = fminf(exit, (boxMax - origin[axis]) / direction[axis]);
+    else if (direction[axis] < 0.0f)
+      exit = fminf(exit, (boxMin - origin[axis]) / direction[axis]);
+  }
+
+  return distance + fmaxf(exit, 0.0f);
+}
+
+bool RaycastTerrain(Ray ray, float maxDistance, float step, Vector3 *hitPoint)
+{
+  ray.direction = Vector3Normalize(ray.direction);
+  float previousDistance = 0.0f;
+  float distance = 0.0f;
+
+  while (distance <= maxDistance)
+  {
+    Vector3 pos = Vector3Add(ray.position, Vector3Scale(ray.direction, distance));
+    int cx, cz;
+    Vector3 localPos;
+
+    if (GetChunkLocalPosition(pos, &cx, &cz, &localPos))
+    {
+      const Chunk *chunk = &chunks[cx][cz].chunk;
+
+      // Jump over bricks that are entirely air without sampling their voxels
+      float exitDistance = GetAirBrickExit(chunk, ray, distance, localPos);
+      if (exitDistance >= 0.0f)
+      {
+        previousDistance = exitDistance;
+        distance = exitDistance + step * 0.5f;
+        continue;
+      }
+
+      if (SampleChunkDensity(chunk, localPos) <= 0.0f)
+      {
+        // Refine the crossing between the last sample outside and this one
+        float low = previousDistance;
+        float high = distance;
+        for (int i = 0; i < 8; i++)
+        {
+          float mid = (low + high) * 0.5f;
+          Vector3 midPos = Vector3Add(ray.position, Vector3Scale(ray.direction, mid));
+          if (GetChunkLocalPosition(midPos, &cx, &cz, &localPos) &&
+              SampleChunkDensity(&chunks[cx][cz].chunk, localPos) <= 0.0f)
+            high = mid;
+          else
+            low = mid;
+        }
+
+        *hitPoint = Vector3Add(ray.position, Vector3Scale(ray.direction, high));
+        return true;
+      }
+    }
+
+    previousDistance = distance;
+    distance += step;
+  }
+
+  return false;
+}
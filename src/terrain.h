@@ -3,12 +3,16 @@
 
 #include "raylib.h"
 #include "chunk.h"
+#include "jobs.h"
 
-// Function declarations for terrain modification
-void ModifyTerrain(Vector3 position, float radius, float strength);
+// Function declarations for terrain modification, brush strokes are spread over the job system workers
+void ModifyTerrain(JobSystem *jobs, Vector3 position, float radius, float strength);
 bool IsInsideTerrain(Vector3 pos);
 float GetDensityAtPosition(Vector3 pos);
 bool GetChunkCoords(Vector3 worldPos, int *chunkX, int *chunkZ, int *vx, int *vy, int *vz);
 Vector3 GetWorldPosition(int chunkX, int chunkZ, int vx, int vy, int vz);
 
+// Function to find the first terrain surface hit along a ray, skipping bricks that are all air
+bool RaycastTerrain(Ray ray, float maxDistance, float step, Vector3 *hitPoint);
+
 #endif // TERRAIN_H
\ No newline at end of file
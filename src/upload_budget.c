@@ -0,0 +1,79 @@
+#include "upload_budget.h"
+#include "raymath.h"
+#include <math.h>
+
+UploadBudget InitializeUploadBudget(int bytesPerFrame, float msPerFrame)
+{
+  UploadBudget budget = {0};
+  budget.bytesPerFrame = bytesPerFrame;
+  budget.msPerFrame = msPerFrame;
+  budget.cameraForward = (Vector3){0.0f, 0.0f, -1.0f};
+  budget.viewAngle = PI;
+  return budget;
+}
+
+void BeginUploadFrame(UploadBudget *budget, Camera camera, float aspect)
+{
+  budget->cameraPosition = camera.position;
+  budget->cameraForward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+
+  // Cone through the corners of the view, a full sphere for orthographic cameras
+  if (camera.projection == CAMERA_PERSPECTIVE)
+  {
+    float halfHeight = tanf(camera.fovy * 0.5f * DEG2RAD);
+    budget->viewAngle = atanf(halfHeight * sqrtf(1.0f + aspect * aspect));
+  }
+  else
+  {
+    budget->viewAngle = PI;
+  }
+
+  budget->bytesUsed = 0;
+  budget->msUsed = 0.0f;
+  budget->uploads = 0;
+}
+
+float GetChunkUploadPriority(const UploadBudget *budget, const ChunkData *chunkData)
+{
+  const float halfExtent = (CHUNK_SIZE - 1) * VOXEL_SIZE * 0.5f;
+  const float radius = halfExtent * sqrtf(3.0f);
+
+  Vector3 center = Vector3AddValue(chunkData->chunk.position, halfExtent);
+  Vector3 toChunk = Vector3Subtract(center, budget->cameraPosition);
+  float distance = Vector3Length(toChunk);
+  if (distance <= radius)
+    return distance;
+
+  // The chunk's bounding sphere is visible when it reaches into the view cone
+  float angle = acosf(Clamp(Vector3DotProduct(toChunk, budget->cameraForward) / distance, -1.0f, 1.0f));
+  bool visible = angle <= budget->viewAngle + asinf(radius / distance);
+
+  return visible ? distance : distance + UPLOAD_HIDDEN_PENALTY;
+}
+
+bool BeginUpload(UploadBudget *budget, int bytes)
+{
+  if (!budget)
+    return true;
+
+  if (budget->uploads > 0)
+  {
+    if (budget->bytesPerFrame > 0 && budget->bytesUsed + bytes > budget->bytesPerFrame)
+      return false;
+    if (budget->msPerFrame > 0.0f && budget->msUsed >= budget->msPerFrame)
+      return false;
+  }
+
+  budget->bytesUsed += bytes;
+  budget->uploads++;
+  budget->uploadStart = GetTime();
+  return true;
+}
+
+void EndUpload(UploadBudget *budget)
+{
+  if (!budget)
+    return;
+
+  budget->msUsed += (float)((GetTime() - budget->uploadStart) * 1000.0);
+}
@@ -0,0 +1,46 @@
+#ifndef UPLOAD_BUDGET_H
+#define UPLOAD_BUDGET_H
+
+#include "raylib.h"
+#include "chunk.h"
+
+// Default mesh upload budget per frame, large enough for about two freshly generated chunks
+#define UPLOAD_BYTES_PER_FRAME (512 * 1024)
+#define UPLOAD_MS_PER_FRAME 2.0f
+
+// Distance added to the priority of chunks outside the view, so every visible chunk goes first
+#define UPLOAD_HIDDEN_PENALTY 10000.0f
+
+// Mesh uploads the render thread may do in one frame, shared by the remesh service and the chunk pipeline
+// Uploads that do not fit wait for a later frame while the old meshes stay visible
+typedef struct
+{
+  int bytesPerFrame; // 0 for no byte limit
+  float msPerFrame;  // 0 for no time limit
+  Vector3 cameraPosition;
+  Vector3 cameraForward;
+  float viewAngle; // Half angle of a cone around the view frustum, in radians
+  int bytesUsed;   // Uploaded since BeginUploadFrame
+  float msUsed;    // Spent uploading since BeginUploadFrame
+  int uploads;     // Uploads started since BeginUploadFrame
+  double uploadStart;
+} UploadBudget;
+
+// Function to create a budget, limits of 0 are unlimited
+UploadBudget InitializeUploadBudget(int bytesPerFrame, float msPerFrame);
+
+// Function to reset the budget at the start of a frame and take the view uploads are prioritized by
+void BeginUploadFrame(UploadBudget *budget, Camera camera, float aspect);
+
+// Function to get the upload priority of a chunk, lower goes first
+float GetChunkUploadPriority(const UploadBudget *budget, const ChunkData *chunkData);
+
+// Function to claim budget for an upload of the given size, returns false when it must wait for a later frame
+// The first upload of a frame always goes ahead so meshes larger than the budget still get through
+// budget may be NULL to upload without limit
+bool BeginUpload(UploadBudget *budget, int bytes);
+
+// Function to charge the time since BeginUpload to the budget
+void EndUpload(UploadBudget *budget);
+
+#endif // UPLOAD_BUDGET_H
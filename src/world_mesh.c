@@ -0,0 +1,552 @@
+#include "world_mesh.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// GL enums used by the page draws
+#define WORLD_GL_TRIANGLES 0x0004      // GL_TRIANGLES
+#define WORLD_GL_UNSIGNED_SHORT 0x1403 // GL_UNSIGNED_SHORT
+
+// glMultiDrawElements, core since OpenGL 1.4 but not exposed by rlgl
+#if defined(_WIN32)
+#define WORLD_GL_APIENTRY __stdcall
+#else
+#define WORLD_GL_APIENTRY
+#endif
+typedef void(WORLD_GL_APIENTRY *MultiDrawElementsFunction)(unsigned int mode, const int *count, unsigned int type,
+                                                           const void *const *indices, int drawCount);
+static MultiDrawElementsFunction multiDrawElements = NULL;
+
+#if defined(PLATFORM_DESKTOP) || defined(PLATFORM_DESKTOP_GLFW)
+// GLFW is built into raylib on desktop platforms
+typedef void (*GLFWglproc)(void);
+GLFWglproc glfwGetProcAddress(const char *procname);
+#endif
+
+// Function to load glMultiDrawElements from the current context, pages fall back to one draw per section without it
+static void LoadMultiDrawElements(void)
+{
+#if defined(PLATFORM_DESKTOP) || defined(PLATFORM_DESKTOP_GLFW)
+  multiDrawElements = (MultiDrawElementsFunction)glfwGetProcAddress("glMultiDrawElements");
+#endif
+  if (!multiDrawElements)
+    TraceLog(LOG_WARNING, "WORLD: glMultiDrawElements is unavailable, drawing one section at a time");
+}
+
+static bool InitializeFreeList(WorldMeshFreeList *list, int size)
+{
+  list->ranges = (WorldMeshRange *)RL_MALLOC(16 * sizeof(WorldMeshRange));
+  if (!list->ranges)
+    return false;
+
+  list->capacity = 16;
+  list->ranges[0] = (WorldMeshRange){0, size};
+  list->count = 1;
+  return true;
+}
+
+static void CleanupFreeList(WorldMeshFreeList *list)
+{
+  RL_FREE(list->ranges);
+  *list = (WorldMeshFreeList){0};
+}
+
+// Function to take count elements from the first free run large enough, returns the start or -1
+static int AllocateRange(WorldMeshFreeList *list, int count)
+{
+  for (int i = 0; i < list->count; i++)
+  {
+    WorldMeshRange *range = &list->ranges[i];
+    if (range->count < count)
+      continue;
+
+    int start = range->start;
+    range->start += count;
+    range->count -= count;
+    if (range->count == 0)
+    {
+      memmove(range, range + 1, (list->count - i - 1) * sizeof(WorldMeshRange));
+      list->count--;
+    }
+    return start;
+  }
+
+  return -1;
+}
+
+// Function to give a run back, merging it with the free runs it touches
+// When the list cannot grow the run stays lost until the world mesh is cleaned up
+static void FreeRange(WorldMeshFreeList *list, WorldMeshRange range)
+{
+  if (range.count == 0)
+    return;
+
+  int i = 0;
+  while (i < list->count && list->ranges[i].start < range.start)
+    i++;
+
+  bool joinsPrevious = i > 0 && list->ranges[i - 1].start + list->ranges[i - 1].count == range.start;
+  bool joinsNext = i < list->count && range.start + range.count == list->ranges[i].start;
+
+  if (joinsPrevious && joinsNext)
+  {
+    list->ranges[i - 1].count += range.count + list->ranges[i].count;
+    memmove(&list->ranges[i], &list->ranges[i + 1], (list->count - i - 1) * sizeof(WorldMeshRange));
+    list->count--;
+  }
+  else if (joinsPrevious)
+  {
+    list->ranges[i - 1].count += range.count;
+  }
+  else if (joinsNext)
+  {
+    list->ranges[i].start = range.start;
+    list->ranges[i].count += range.count;
+  }
+  else
+  {
+    if (list->count == list->capacity)
+    {
+      WorldMeshRange *ranges = (WorldMeshRange *)RL_REALLOC(list->ranges, 2 * list->capacity * sizeof(WorldMeshRange));
+      if (!ranges)
+        return;
+      list->ranges = ranges;
+      list->capacity *= 2;
+    }
+
+    memmove(&list->ranges[i + 1], &list->ranges[i], (list->count - i) * sizeof(WorldMeshRange));
+    list->ranges[i] = range;
+    list->count++;
+  }
+}
+
+// Function to add an empty page, returns false when out of memory
+static bool AddWorldMeshPage(WorldMesh *world)
+{
+  WorldMeshPage *pages = (WorldMeshPage *)RL_REALLOC(world->pages, (world->pageCount + 1) * sizeof(WorldMeshPage));
+  if (!pages)
+    return false;
+  world->pages = pages;
+
+  WorldMeshPage page = {0};
+  bool allocated = InitializeFreeList(&page.freeVertices, WORLD_PAGE_VERTICES);
+  allocated = InitializeFreeList(&page.freeIndices, WORLD_PAGE_INDICES) && allocated;
+  if (!allocated)
+  {
+    CleanupFreeList(&page.freeVertices);
+    CleanupFreeList(&page.freeIndices);
+    return false;
+  }
+
+  page.vaoId = rlLoadVertexArray();
+  rlEnableVertexArray(page.vaoId);
+  page.vertexBufferId = rlLoadVertexBuffer(NULL, WORLD_PAGE_VERTICES * sizeof(ChunkVertex), true);
+  SetChunkVertexAttributes();
+  page.slotBufferId = rlLoadVertexBuffer(NULL, WORLD_PAGE_VERTICES * sizeof(unsigned short), true);
+  if (world->slotLocation >= 0)
+  {
+    rlSetVertexAttribute(world->slotLocation, 1, WORLD_GL_UNSIGNED_SHORT, false, 0, 0);
+    rlEnableVertexAttribute(world->slotLocation);
+  }
+  page.indexBufferId = rlLoadVertexBufferElement(NULL, WORLD_PAGE_INDICES * sizeof(unsigned short), true);
+  rlDisableVertexArray();
+
+  world->pages[world->pageCount++] = page;
+  return true;
+}
+
+// Function to get an unused slot, returns 0 when out of memory
+static int AcquireWorldMeshSlot(WorldMesh *world)
+{
+  for (int i = world->firstFreeSlot; i < world->slotCount; i++)
+  {
+    if (world->slots[i].page < 0)
+    {
+      world->firstFreeSlot = i + 1;
+      return i;
+    }
+  }
+
+  if (world->slotCount >= world->slotCapacity)
+  {
+    int capacity = world->slotCapacity > 0 ? 2 * world->slotCapacity : SECTION_COUNT;
+    WorldMeshSlot *slots = (WorldMeshSlot *)RL_REALLOC(world->slots, capacity * sizeof(WorldMeshSlot));
+    if (!slots)
+      return 0;
+    if (world->slotCapacity == 0)
+      slots[0] = (WorldMeshSlot){.page = -1};
+    world->slots = slots;
+    world->slotCapacity = capacity;
+  }
+
+  int slot = world->slotCount++;
+  world->slots[slot] = (WorldMeshSlot){.page = -1};
+  world->firstFreeSlot = world->slotCount;
+  return slot;
+}
+
+// Function to reserve ranges in the first page with room, adding a page when none has, returns the page or -1
+static int ReserveRanges(WorldMesh *world, int vertexCount, int indexCount, WorldMeshRange *vertices, WorldMeshRange *indices)
+{
+  for (int p = 0; p <= world->pageCount; p++)
+  {
+    bool added = p == world->pageCount;
+    if (added && !AddWorldMeshPage(world))
+      return -1;
+
+    // A free page-local id first, so attaching the slot cannot fail
+    WorldMeshPage *page = &world->pages[p];
+    if (page->slotCount == WORLD_PAGE_SLOTS)
+      continue;
+
+    int vertexStart = AllocateRange(&page->freeVertices, vertexCount);
+    int indexStart = vertexStart >= 0 ? AllocateRange(&page->freeIndices, indexCount) : -1;
+    if (indexStart >= 0)
+    {
+      *vertices = (WorldMeshRange){vertexStart, vertexCount};
+      *indices = (WorldMeshRange){indexStart, indexCount};
+      return p;
+    }
+
+    if (vertexStart >= 0)
+      FreeRange(&page->freeVertices, (WorldMeshRange){vertexStart, vertexCount});
+    if (added)
+      return -1;
+  }
+
+  return -1;
+}
+
+// Function to give a slot ranges reserved by ReserveRanges and a free page-local id, written to every vertex of the range
+static void AttachSlotRanges(WorldMesh *world, int slotIndex, int pageIndex, WorldMeshRange vertices, WorldMeshRange indices)
+{
+  WorldMeshSlot *slot = &world->slots[slotIndex];
+  WorldMeshPage *page = &world->pages[pageIndex];
+
+  int id = 0;
+  while (page->slots[id] != 0)
+    id++;
+
+  slot->page = pageIndex;
+  slot->pageIndex = id;
+  slot->vertices = vertices;
+  slot->indices = indices;
+  page->slots[id] = slotIndex;
+  page->slotCount++;
+
+  // The id only changes when the slot moves, so it is written once per range rather than per upload
+  unsigned short ids[WORLD_RANGE_MIN_VERTICES];
+  for (int i = 0; i < WORLD_RANGE_MIN_VERTICES; i++)
+  {
+    ids[i] = (unsigned short)id;
+  }
+  for (int start = 0; start < vertices.count; start += WORLD_RANGE_MIN_VERTICES)
+  {
+    int count = vertices.count - start < WORLD_RANGE_MIN_VERTICES ? vertices.count - start : WORLD_RANGE_MIN_VERTICES;
+    rlUpdateVertexBuffer(page->slotBufferId, ids, count * sizeof(unsigned short),
+                         (vertices.start + start) * sizeof(unsigned short));
+  }
+}
+
+// Function to give the ranges and page-local id of a slot back to its page
+static void ReleaseSlotRanges(WorldMesh *world, int slotIndex)
+{
+  WorldMeshSlot *slot = &world->slots[slotIndex];
+  WorldMeshPage *page = &world->pages[slot->page];
+
+  FreeRange(&page->freeVertices, slot->vertices);
+  FreeRange(&page->freeIndices, slot->indices);
+
+  page->slots[slot->pageIndex] = 0;
+  page->slotCount--;
+}
+
+// Function to free a slot and its ranges
+static void ReleaseWorldMeshSlot(WorldMesh *world, int slotIndex)
+{
+  if (world->slots[slotIndex].page >= 0)
+    ReleaseSlotRanges(world, slotIndex);
+  world->slots[slotIndex] = (WorldMeshSlot){.page = -1};
+  if (slotIndex < world->firstFreeSlot)
+    world->firstFreeSlot = slotIndex;
+}
+
+// Function to get the capacity a range grows to so it holds count elements
+static int GrowRangeCapacity(int capacity, int count, int minimum)
+{
+  if (capacity < minimum)
+    capacity = minimum;
+  while (capacity < count)
+    capacity *= 2;
+  return capacity;
+}
+
+// Function to replace the geometry held by a slot, acquiring it on the first mesh, data is consumed
+// slotIndex stays 0 when the mesh is empty or does not fit
+static void UpdateWorldMeshSlot(WorldMesh *world, int *slotIndex, SectionMeshData *data, Vector3 offset, float scale)
+{
+  int indexCount = data->triangleCount * 3;
+
+  if (*slotIndex == 0)
+  {
+    if (data->vertexCount == 0)
+      return;
+
+    *slotIndex = AcquireWorldMeshSlot(world);
+    if (*slotIndex == 0)
+    {
+      UnloadSectionMeshData(data);
+      return;
+    }
+  }
+
+  WorldMeshSlot *slot = &world->slots[*slotIndex];
+  if (slot->page < 0 || data->vertexCount > slot->vertices.count || indexCount > slot->indices.count)
+  {
+    // Reserve the new ranges before releasing the old ones, so the old mesh stays when memory runs out
+    WorldMeshRange vertices, indices;
+    int page = ReserveRanges(world, GrowRangeCapacity(slot->vertices.count, data->vertexCount, WORLD_RANGE_MIN_VERTICES),
+                             GrowRangeCapacity(slot->indices.count, indexCount, WORLD_RANGE_MIN_INDICES),
+                             &vertices, &indices);
+    if (page < 0)
+    {
+      if (slot->page < 0)
+      {
+        ReleaseWorldMeshSlot(world, *slotIndex);
+        *slotIndex = 0;
+      }
+      UnloadSectionMeshData(data);
+      return;
+    }
+
+    if (slot->page >= 0)
+      ReleaseSlotRanges(world, *slotIndex);
+    AttachSlotRanges(world, *slotIndex, page, vertices, indices);
+  }
+
+  WorldMeshPage *page = &world->pages[slot->page];
+  if (data->vertexCount > 0)
+  {
+    // Indices become page-absolute, so the whole page draws from one vertex array
+    for (int i = 0; i < indexCount; i++)
+    {
+      data->indices[i] += (unsigned short)slot->vertices.start;
+    }
+
+    rlUpdateVertexBuffer(page->vertexBufferId, data->vertices, data->vertexCount * sizeof(ChunkVertex),
+                         slot->vertices.start * sizeof(ChunkVertex));
+
+    // The index buffer binding is vertex array state, so the page's array must be bound for the update
+    rlEnableVertexArray(page->vaoId);
+    rlUpdateVertexBufferElements(page->indexBufferId, data->indices, indexCount * sizeof(unsigned short),
+                                 slot->indices.start * sizeof(unsigned short));
+    rlDisableVertexArray();
+  }
+
+  slot->vertexCount = data->vertexCount;
+  slot->indexCount = indexCount;
+  page->offsets[slot->pageIndex] = (Vector4){offset.x, offset.y, offset.z, scale};
+  UnloadSectionMeshData(data);
+}
+
+WorldMesh InitializeWorldMesh(Material material)
+{
+  WorldMesh world = {0};
+  world.material = material;
+  world.slotLocation = GetShaderLocationAttrib(material.shader, "vertexSlot");
+  world.chunkOffsetsLocation = GetShaderLocation(material.shader, "chunkOffsets");
+  if (world.slotLocation < 0 || world.chunkOffsetsLocation < 0)
+    TraceLog(LOG_WARNING, "WORLD: Shader has no vertexSlot attribute or chunkOffsets uniform, chunks will draw at the origin");
+  LoadMultiDrawElements();
+
+  // Slot 0 is reserved and never handed out, so a zeroed section owns no slot
+  world.slotCount = 1;
+  world.firstFreeSlot = 1;
+  return world;
+}
+
+void CleanupWorldMesh(WorldMesh *world)
+{
+  for (int p = 0; p < world->pageCount; p++)
+  {
+    WorldMeshPage *page = &world->pages[p];
+    rlUnloadVertexArray(page->vaoId);
+    rlUnloadVertexBuffer(page->vertexBufferId);
+    rlUnloadVertexBuffer(page->slotBufferId);
+    rlUnloadVertexBuffer(page->indexBufferId);
+    CleanupFreeList(&page->freeVertices);
+    CleanupFreeList(&page->freeIndices);
+  }
+
+  RL_FREE(world->pages);
+  RL_FREE(world->slots);
+  *world = (WorldMesh){0};
+}
+
+void UpdateChunkSectionMesh(WorldMesh *world, ChunkData *chunkData, int sx, int sy, int sz, SectionMeshData *data)
+{
+  UpdateWorldMeshSlot(world, &chunkData->sections[sx][sy][sz].slot, data, chunkData->chunk.position, 1.0f);
+}
+
+int UpdateChunkMesh(WorldMesh *world, MeshingContext *context, ChunkData *chunkData)
+{
+  int remeshed = 0;
+
+  for (int sx = 0; sx < SECTIONS_PER_AXIS; sx++)
+  {
+    for (int sy = 0; sy < SECTIONS_PER_AXIS; sy++)
+    {
+      for (int sz = 0; sz < SECTIONS_PER_AXIS; sz++)
+      {
+        ChunkSection *section = &chunkData->sections[sx][sy][sz];
+        if (!section->dirty)
+          continue;
+
+        SectionMeshData data = BuildSectionMesh(context, &chunkData->chunk, sx, sy, sz);
+        UpdateChunkSectionMesh(world, chunkData, sx, sy, sz, &data);
+        section->dirty = false;
+        remeshed++;
+      }
+    }
+  }
+
+  return remeshed;
+}
+
+void UpdateChunkPreviewMesh(WorldMesh *world, ChunkData *chunkData, SectionMeshData *data)
+{
+  // Preview voxels are CHUNK_PREVIEW_STEP voxels apart
+  UpdateWorldMeshSlot(world, &chunkData->previewSlot, data, chunkData->chunk.position, CHUNK_PREVIEW_STEP);
+}
+
+void UnloadChunkPreviewMesh(WorldMesh *world, ChunkData *chunkData)
+{
+  if (chunkData->previewSlot != 0)
+    ReleaseWorldMeshSlot(world, chunkData->previewSlot);
+  chunkData->previewSlot = 0;
+}
+
+void UnloadChunkMesh(WorldMesh *world, ChunkData *chunkData)
+{
+  UnloadChunkPreviewMesh(world, chunkData);
+
+  for (int sx = 0; sx < SECTIONS_PER_AXIS; sx++)
+  {
+    for (int sy = 0; sy < SECTIONS_PER_AXIS; sy++)
+    {
+      for (int sz = 0; sz < SECTIONS_PER_AXIS; sz++)
+      {
+        ChunkSection *section = &chunkData->sections[sx][sy][sz];
+        if (section->slot != 0)
+          ReleaseWorldMeshSlot(world, section->slot);
+        section->slot = 0;
+      }
+    }
+  }
+}
+
+void DrawWorldMesh(WorldMesh *world)
+{
+  Shader shader = world->material.shader;
+  world->drawCalls = 0;
+
+  // Vertices are chunk-local, scaled and moved by their chunkOffsets entry, so the model matrix is the identity
+  Matrix matView = rlGetMatrixModelview();
+  Matrix matProjection = rlGetMatrixProjection();
+  rlEnableShader(shader.id);
+  if (shader.locs[SHADER_LOC_MATRIX_VIEW] != -1)
+    rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_VIEW], matView);
+  if (shader.locs[SHADER_LOC_MATRIX_PROJECTION] != -1)
+    rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_PROJECTION], matProjection);
+  if (shader.locs[SHADER_LOC_MATRIX_MODEL] != -1)
+    rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_MODEL], MatrixIdentity());
+  if (shader.locs[SHADER_LOC_MATRIX_NORMAL] != -1)
+    rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_NORMAL], MatrixIdentity());
+  if (shader.locs[SHADER_LOC_COLOR_DIFFUSE] != -1)
+  {
+    Color color = world->material.maps[MATERIAL_MAP_DIFFUSE].color;
+    float values[4] = {color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f};
+    rlSetUniform(shader.locs[SHADER_LOC_COLOR_DIFFUSE], values, SHADER_UNIFORM_VEC4, 1);
+  }
+  rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(matView, matProjection));
+
+  // Sections of a page share its vertex array and page-absolute indices, so one multi-draw covers them all
+  for (int p = 0; p < world->pageCount; p++)
+  {
+    WorldMeshPage *page = &world->pages[p];
+    int counts[WORLD_PAGE_SLOTS];
+    const void *offsets[WORLD_PAGE_SLOTS];
+    int drawCount = 0;
+
+    for (int id = 0; id < WORLD_PAGE_SLOTS; id++)
+    {
+      if (page->slots[id] == 0)
+        continue;
+
+      const WorldMeshSlot *slot = &world->slots[page->slots[id]];
+      if (slot->indexCount == 0)
+        continue;
+
+      counts[drawCount] = slot->indexCount;
+      offsets[drawCount] = (const void *)(uintptr_t)(slot->indices.start * sizeof(unsigned short));
+      drawCount++;
+    }
+    if (drawCount == 0)
+      continue;
+
+    if (world->chunkOffsetsLocation >= 0)
+      rlSetUniform(world->chunkOffsetsLocation, page->offsets, SHADER_UNIFORM_VEC4, WORLD_PAGE_SLOTS);
+
+    rlEnableVertexArray(page->vaoId);
+    if (multiDrawElements)
+    {
+      multiDrawElements(WORLD_GL_TRIANGLES, counts, WORLD_GL_UNSIGNED_SHORT, offsets, drawCount);
+      world->drawCalls++;
+    }
+    else
+    {
+      for (int i = 0; i < drawCount; i++)
+      {
+        rlDrawVertexArrayElements((int)((uintptr_t)offsets[i] / sizeof(unsigned short)), counts[i], 0);
+      }
+      world->drawCalls += drawCount;
+    }
+  }
+  rlDisableVertexArray();
+
+  rlDisableShader();
+}
+
+WorldMeshStats GetWorldMeshStats(const WorldMesh *world)
+{
+  WorldMeshStats stats = {0};
+  stats.pageCount = world->pageCount;
+  stats.totalBytes = world->pageCount * (WORLD_PAGE_VERTICES * (int)sizeof(ChunkVertex) + WORLD_PAGE_INDICES * (int)sizeof(unsigned short));
+
+  for (int p = 0; p < world->pageCount; p++)
+  {
+    const WorldMeshPage *page = &world->pages[p];
+    for (int id = 0; id < WORLD_PAGE_SLOTS; id++)
+    {
+      if (page->slots[id] == 0)
+        continue;
+
+      const WorldMeshSlot *slot = &world->slots[page->slots[id]];
+      if (page->offsets[id].w == 1.0f)
+        stats.sectionCount++;
+      else
+        stats.previewCount++;
+      stats.usedBytes += slot->vertexCount * (int)sizeof(ChunkVertex) + slot->indexCount * (int)sizeof(unsigned short);
+      stats.reservedBytes += slot->vertices.count * (int)sizeof(ChunkVertex) + slot->indices.count * (int)sizeof(unsigned short);
+    }
+    for (int i = 0; i < page->freeVertices.count; i++)
+    {
+      if (page->freeVertices.ranges[i].count > stats.largestFreeVertices)
+        stats.largestFreeVertices = page->freeVertices.ranges[i].count;
+    }
+  }
+
+  return stats;
+}
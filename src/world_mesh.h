@@ -0,0 +1,115 @@
+#ifndef WORLD_MESH_H
+#define WORLD_MESH_H
+
+#include "raylib.h"
+#include "chunk.h"
+#include "marching_cubes.h"
+
+// Vertices and indices of one world mesh page, each page is drawn with one multi-draw
+// Indices are page-absolute and 16-bit, so a page holds at most 65536 vertices
+#define WORLD_PAGE_VERTICES 65536
+#define WORLD_PAGE_INDICES (384 * 1024)
+
+// Sections per page, must match the size of the chunkOffsets array in lighting_shader.vs
+#define WORLD_PAGE_SLOTS 128
+
+// Smallest ranges handed to a section, doubled until a remeshed section fits
+#define WORLD_RANGE_MIN_VERTICES 256
+#define WORLD_RANGE_MIN_INDICES 1024
+
+// Run of vertices or indices inside a page buffer
+typedef struct
+{
+  int start;
+  int count;
+} WorldMeshRange;
+
+// Free runs of a page buffer, sorted by start and merged with their neighbours
+typedef struct
+{
+  WorldMeshRange *ranges;
+  int count;
+  int capacity;
+} WorldMeshFreeList;
+
+// Geometry of one chunk section inside a page
+typedef struct
+{
+  int page;                 // Page the ranges are in, -1 for an unused slot
+  int pageIndex;            // Page-local id, written to every vertex of the range to select its chunk offset
+  WorldMeshRange vertices;  // Reserved vertices, the used ones start the range
+  WorldMeshRange indices;   // Reserved indices, the used ones start the range
+  int vertexCount;
+  int indexCount;
+} WorldMeshSlot;
+
+// Vertex and index buffer shared by many sections, with the vertex array that draws them
+typedef struct
+{
+  unsigned int vaoId;
+  unsigned int vertexBufferId;
+  unsigned int slotBufferId; // Page-local id of the section each vertex belongs to
+  unsigned int indexBufferId;
+  WorldMeshFreeList freeVertices;
+  WorldMeshFreeList freeIndices;
+  int slots[WORLD_PAGE_SLOTS];       // Slot of each page-local id, 0 when the id is free
+  Vector4 offsets[WORLD_PAGE_SLOTS]; // Chunk position and vertex scale of each page-local id
+  int slotCount;
+} WorldMeshPage;
+
+// Chunk geometry sub-allocated from a few large GPU buffers, so every chunk draws with one multi-draw per page
+// Sections keep chunk-local vertices, each vertex carries a page-local id that picks its chunk position and scale
+// from a uniform array. Nothing is kept on the CPU once uploaded, spatial queries answer from the voxels
+typedef struct
+{
+  WorldMeshPage *pages;
+  int pageCount;
+  WorldMeshSlot *slots; // Slot 0 is never used, so zeroed sections own no slot
+  int slotCount;
+  int slotCapacity;
+  int firstFreeSlot; // Lowest slot that may be unused
+  Material material;
+  int slotLocation;         // Attribute location of vertexSlot in the material shader
+  int chunkOffsetsLocation; // Uniform location of chunkOffsets in the material shader
+  int drawCalls;            // Draw calls issued by the last DrawWorldMesh, one per page with multi-draw
+} WorldMesh;
+
+// Usage of the page buffers, for tuning the page size
+typedef struct
+{
+  int pageCount;
+  int sectionCount;
+  int previewCount;
+  int usedBytes;     // Holding section geometry
+  int reservedBytes; // Reserved by sections, used or not
+  int totalBytes;    // Size of every page buffer
+  int largestFreeVertices; // Largest free vertex run, small next to the free total means fragmentation
+} WorldMeshStats;
+
+// World mesh management, the material's shader must declare the vertexSlot attribute and chunkOffsets uniform
+WorldMesh InitializeWorldMesh(Material material);
+void CleanupWorldMesh(WorldMesh *world);
+
+// Function to replace the geometry of one section of a chunk, data is consumed
+// The section keeps its ranges while the mesh fits and only moves, to ranges at least twice as large, when it outgrows them
+void UpdateChunkSectionMesh(WorldMesh *world, ChunkData *chunkData, int sx, int sy, int sz, SectionMeshData *data);
+
+// Function to remesh the dirty sections of a chunk on the calling thread, returns the number of sections remeshed
+int UpdateChunkMesh(WorldMesh *world, MeshingContext *context, ChunkData *chunkData);
+
+// Function to replace the coarse preview of a chunk, from a preview chunk's first section, data is consumed
+void UpdateChunkPreviewMesh(WorldMesh *world, ChunkData *chunkData, SectionMeshData *data);
+
+// Function to free the ranges of the preview of a chunk, once its sections replace it
+void UnloadChunkPreviewMesh(WorldMesh *world, ChunkData *chunkData);
+
+// Function to free the ranges of every section and the preview of a chunk
+void UnloadChunkMesh(WorldMesh *world, ChunkData *chunkData);
+
+// Function to draw every section with geometry, call between BeginMode3D and EndMode3D
+void DrawWorldMesh(WorldMesh *world);
+
+// Function to get the buffer usage of the world mesh
+WorldMeshStats GetWorldMeshStats(const WorldMesh *world);
+
+#endif // WORLD_MESH_H